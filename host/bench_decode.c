@@ -0,0 +1,134 @@
+#include <stdio.h>
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "protocol.h"
+#include "status_board.h"
+#include "weather_layer.h"
+#include "config.h"
+#include "perf.h"
+
+// Times the bridge response decoder against the dict_find chain success()
+// used before it: one dict_find per field, each walking the dictionary from
+// the start. Both run over the same full response, with the reserved keys
+// http.c reads first, so the walk lengths match what the watch sees.
+
+#define ITERATIONS 200000
+
+static uint8_t tuples_response[PROTOCOL_INBOUND_LIMIT];
+static uint16_t tuples_size;
+static uint8_t packed_response[PROTOCOL_INBOUND_LIMIT];
+static uint16_t packed_size;
+
+static void write_reserved(DictionaryIterator* iter) {
+	dict_write_uint8(iter, HTTP_URL_KEY, 1);
+	dict_write_int16(iter, HTTP_STATUS_KEY, 200);
+	dict_write_int32(iter, HTTP_COOKIE_KEY, WEATHER_HTTP_COOKIE);
+	dict_write_int32(iter, HTTP_APP_ID_KEY, 24134131);
+	dict_write_int16(iter, CHECKDIGITS, 1234);
+}
+
+static void record() {
+	DictionaryIterator iter;
+	dict_write_begin(&iter, tuples_response, sizeof(tuples_response));
+	write_reserved(&iter);
+	dict_write_int8(&iter, WEATHER_KEY_ICON, WEATHER_ICON_RAIN);
+	dict_write_int16(&iter, WEATHER_KEY_TEMPERATURE, 21);
+	dict_write_int16(&iter, EMAIL_KEY_UNREAD, 4);
+	dict_write_int16(&iter, SEND_VIBRATE, 1);
+	dict_write_int16(&iter, UNREAD_FACEBOOK_MESSAGES, 2);
+	dict_write_uint32(&iter, PAYLOAD_VERSION, 7);
+	tuples_size = dict_write_end(&iter);
+
+	uint8_t packed[STATUS_BOARD_PACKED_SIZE] = {
+		[PACKED_OFFSET_VERSION] = STATUS_BOARD_PACKED_VERSION,
+		[PACKED_OFFSET_PRESENT] = STATUS_BOARD_HAS_ICON | STATUS_BOARD_HAS_TEMPERATURE |
+			STATUS_BOARD_HAS_UNREAD_EMAIL | STATUS_BOARD_HAS_VIBRATE |
+			STATUS_BOARD_HAS_UNREAD_FACEBOOK | STATUS_BOARD_HAS_VERSION,
+		[PACKED_OFFSET_ICON] = WEATHER_ICON_RAIN,
+		[PACKED_OFFSET_TEMPERATURE] = 21,
+		[PACKED_OFFSET_UNREAD_EMAIL] = 4,
+		[PACKED_OFFSET_UNREAD_FACEBOOK] = 2,
+		[PACKED_OFFSET_VIBRATE] = 1,
+		[PACKED_OFFSET_PAYLOAD_VERSION] = 7,
+	};
+	dict_write_begin(&iter, packed_response, sizeof(packed_response));
+	write_reserved(&iter);
+	dict_write_data(&iter, STATUS_BOARD_PACKED, packed, sizeof(packed));
+	packed_size = dict_write_end(&iter);
+}
+
+// The lookups success() made before status_board_decode, filling the same
+// struct so both sides do the same work with the values.
+static void decode_lookup_chain(DictionaryIterator* received, StatusBoardUpdate* update) {
+	memset(update, 0, sizeof(StatusBoardUpdate));
+	Tuple* checkdigits_tuple = dict_find(received, CHECKDIGITS);
+	if (!checkdigits_tuple) return;
+	update->present |= STATUS_BOARD_HAS_CHECKDIGITS;
+	update->checkdigits = checkdigits_tuple->value->int16;
+
+	Tuple* activation_tuple = dict_find(received, ACTIVATION_CODE);
+	if (activation_tuple) {
+		update->present |= STATUS_BOARD_HAS_ACTIVATION_CODE;
+		memcpy(update->activation_code, activation_tuple->value->cstring, sizeof(update->activation_code) - 1);
+		return;
+	}
+	Tuple* icon_tuple = dict_find(received, WEATHER_KEY_ICON);
+	if (icon_tuple && icon_tuple->value->int8 >= 0 && icon_tuple->value->int8 < WEATHER_ICON_NO_WEATHER) {
+		update->present |= STATUS_BOARD_HAS_ICON;
+		update->icon = icon_tuple->value->int8;
+	}
+	Tuple* temperature_tuple = dict_find(received, WEATHER_KEY_TEMPERATURE);
+	if (temperature_tuple) {
+		update->present |= STATUS_BOARD_HAS_TEMPERATURE;
+		update->temperature = temperature_tuple->value->int16;
+	}
+	Tuple* email_tuple = dict_find(received, EMAIL_KEY_UNREAD);
+	Tuple* vibrate_tuple = dict_find(received, SEND_VIBRATE);
+	if (vibrate_tuple) {
+		update->present |= STATUS_BOARD_HAS_VIBRATE;
+		update->vibrate = vibrate_tuple->value->int16;
+	}
+	if (email_tuple) {
+		update->present |= STATUS_BOARD_HAS_UNREAD_EMAIL;
+		update->unread_email = email_tuple->value->int16;
+	}
+	Tuple* facebook_tuple = dict_find(received, UNREAD_FACEBOOK_MESSAGES);
+	if (facebook_tuple) {
+		update->present |= STATUS_BOARD_HAS_UNREAD_FACEBOOK;
+		update->unread_facebook = facebook_tuple->value->int16;
+	}
+}
+
+static void decode_single_walk(DictionaryIterator* received, StatusBoardUpdate* update) {
+	status_board_decode(received, update);
+	status_board_validate(update);
+}
+
+typedef void (*Decoder)(DictionaryIterator* received, StatusBoardUpdate* update);
+
+// Prints nanoseconds per response. The checksum keeps the decoded values
+// live so the loop can't be optimised away, and shows both sides agree.
+static void run(const char* name, Decoder decoder, const uint8_t* buffer, uint16_t size) {
+	DictionaryIterator iter;
+	StatusBoardUpdate update;
+	uint32_t checksum = 0;
+	uint32_t start = perf_cycles();
+	for (int i = 0; i < ITERATIONS; i++) {
+		dict_read_begin_from_buffer(&iter, buffer, size);
+		decoder(&iter, &update);
+		checksum += update.icon + update.temperature +
+			update.unread_email + update.unread_facebook + update.vibrate;
+	}
+	uint32_t elapsed = perf_cycles() - start;
+	printf("decode %-12s bytes=%u ns/response=%u.%02u checksum=%u\n", name, size,
+		elapsed / ITERATIONS, (uint32_t)((uint64_t)elapsed * 100 / ITERATIONS % 100), checksum);
+}
+
+int main(void) {
+	record();
+	run("dict_find", decode_lookup_chain, tuples_response, tuples_size);
+	run("single_walk", decode_single_walk, tuples_response, tuples_size);
+	run("packed", decode_single_walk, packed_response, packed_size);
+	return 0;
+}
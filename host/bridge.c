@@ -0,0 +1,322 @@
+#include <stdlib.h>
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "http.h"
+#include "http_keys.h"
+#include "protocol.h"
+#include "status_board.h"
+#include "weather_layer.h"
+#include "host.h"
+
+// The phone side of the link: the httpebble bridge and the status board
+// server behind it, answering from a script of one day. The weather follows
+// the time of day, mail and Facebook messages arrive and get read at fixed
+// minutes, and the payload version only moves when the content does, so
+// "not modified" answers come out the way they would from the real server.
+
+// Reply latencies: the server round trip, a GPS fix, and the phone's local
+// cookie store and clock
+#define BRIDGE_HTTP_MS 800
+#define BRIDGE_LOCATION_MS 2000
+#define BRIDGE_LOCAL_MS 100
+#define BRIDGE_RECONNECT_MS 500
+
+#define BRIDGE_MESSAGE_MAX 256
+
+// Where the phone is, and how sure it is
+#define BRIDGE_LATITUDE 40.7128f
+#define BRIDGE_LONGITUDE -74.006f
+#define BRIDGE_ALTITUDE 10.f
+#define BRIDGE_ACCURACY 30.f
+
+#define BRIDGE_COOKIE_CAPACITY 4
+
+typedef struct {
+	bool in_use;
+	int32_t app_id;
+	uint32_t key;
+	TupleType type;
+	uint16_t length;
+	uint8_t value[HTTP_QUEUE_VALUE_MAX];
+} BridgeCookie;
+
+typedef struct {
+	int8_t icon;
+	int16_t temperature;
+	int16_t unread_email;
+	int16_t unread_facebook;
+} BridgeContent;
+
+static bool connected = true;
+static BridgeStats stats;
+static BridgeCookie cookies[BRIDGE_COOKIE_CAPACITY];
+static BridgeContent served;
+static uint32_t version;
+static int16_t last_unread_email;
+
+// Weather for each three hours of the day
+static const WeatherIcon SKY[8] = {
+	WEATHER_ICON_CLEAR_NIGHT,
+	WEATHER_ICON_CLEAR_NIGHT,
+	WEATHER_ICON_FOG,
+	WEATHER_ICON_PARTLY_CLOUDY_DAY,
+	WEATHER_ICON_CLOUDY,
+	WEATHER_ICON_RAIN,
+	WEATHER_ICON_PARTLY_CLOUDY_NIGHT,
+	WEATHER_ICON_CLEAR_NIGHT,
+};
+
+// Messages that arrived every period minutes between first and last, and
+// were not yet read at one of the reads minutes.
+static int16_t unread(int minute, int period, int first, int last, const int* reads, int read_count) {
+	int since = 0;
+	for (int i = 0; i < read_count; i++) {
+		if (reads[i] <= minute) since = reads[i];
+	}
+	int16_t count = 0;
+	for (int m = since + 1; m <= minute && m < last; m++) {
+		if (m >= first && m % period == 0) count++;
+	}
+	return count;
+}
+
+static BridgeContent content_now() {
+	static const int EMAIL_READS[] = { 9 * 60, 13 * 60, 18 * 60 };
+	static const int FACEBOOK_READS[] = { 12 * 60, 20 * 60 };
+	int minute = (int)(host_now() / HOST_MS_PER_MINUTE) % (24 * 60);
+	return (BridgeContent){
+		.icon = SKY[minute / 180],
+		// Coldest before dawn, warmest mid-afternoon
+		.temperature = 6 + 12 * (720 - abs(minute - 900)) / 720,
+		.unread_email = unread(minute, 53, 7 * 60, 22 * 60, EMAIL_READS, 3),
+		.unread_facebook = unread(minute, 97, 8 * 60, 23 * 60, FACEBOOK_READS, 2),
+	};
+}
+
+static uint32_t float_bits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static void reply(DictionaryIterator* iter, uint8_t* buffer, uint32_t delay_ms) {
+	host_inbox_push(buffer, dict_write_end(iter), delay_ms);
+}
+
+static int32_t int_value(const Tuple* tuple) {
+	switch (tuple->length) {
+	case 1: return tuple->type == TUPLE_INT ? tuple->value->int8 : tuple->value->uint8;
+	case 2: return tuple->type == TUPLE_INT ? tuple->value->int16 : tuple->value->uint16;
+	default: return tuple->value->int32;
+	}
+}
+
+static void pack_int16(uint8_t* data, int16_t value) {
+	data[0] = value & 0xFF;
+	data[1] = (value >> 8) & 0xFF;
+}
+
+static void write_packed(DictionaryIterator* out, const BridgeContent* content, bool vibrate) {
+	uint8_t packed[STATUS_BOARD_PACKED_SIZE];
+	memset(packed, 0, sizeof(packed));
+	packed[PACKED_OFFSET_VERSION] = STATUS_BOARD_PACKED_VERSION;
+	packed[PACKED_OFFSET_PRESENT] = STATUS_BOARD_HAS_ICON | STATUS_BOARD_HAS_TEMPERATURE |
+		STATUS_BOARD_HAS_UNREAD_EMAIL | STATUS_BOARD_HAS_UNREAD_FACEBOOK |
+		STATUS_BOARD_HAS_VERSION | (vibrate ? STATUS_BOARD_HAS_VIBRATE : 0);
+	packed[PACKED_OFFSET_ICON] = (uint8_t)content->icon;
+	pack_int16(&packed[PACKED_OFFSET_TEMPERATURE], content->temperature);
+	pack_int16(&packed[PACKED_OFFSET_UNREAD_EMAIL], content->unread_email);
+	pack_int16(&packed[PACKED_OFFSET_UNREAD_FACEBOOK], content->unread_facebook);
+	packed[PACKED_OFFSET_VIBRATE] = vibrate;
+	for (int i = 0; i < 4; i++) {
+		packed[PACKED_OFFSET_PAYLOAD_VERSION + i] = (version >> (8 * i)) & 0xFF;
+	}
+	dict_write_data(out, STATUS_BOARD_PACKED, packed, sizeof(packed));
+}
+
+static void write_tuples(DictionaryIterator* out, const BridgeContent* content, bool vibrate) {
+	dict_write_int8(out, WEATHER_KEY_ICON, content->icon);
+	dict_write_int16(out, WEATHER_KEY_TEMPERATURE, content->temperature);
+	dict_write_int16(out, EMAIL_KEY_UNREAD, content->unread_email);
+	dict_write_int16(out, UNREAD_FACEBOOK_MESSAGES, content->unread_facebook);
+	if (vibrate) dict_write_int16(out, SEND_VIBRATE, 1);
+	dict_write_uint32(out, PAYLOAD_VERSION, version);
+}
+
+static void answer_data(DictionaryIterator* request) {
+	uint8_t buffer[BRIDGE_MESSAGE_MAX];
+	DictionaryIterator out;
+	Tuple* cookie = dict_find(request, HTTP_COOKIE_KEY);
+	Tuple* app_id = dict_find(request, HTTP_APP_ID_KEY);
+	Tuple* nonce = dict_find(request, WEATHER_KEY_UNIT_SYSTEM);
+	Tuple* known = dict_find(request, WEATHER_KEY_VERSION);
+	Tuple* packed = dict_find(request, WEATHER_KEY_PACKED_FORMAT);
+	stats.data_requests++;
+
+	BridgeContent content = content_now();
+	if (memcmp(&content, &served, sizeof(content)) != 0) {
+		served = content;
+		version++;
+	}
+
+	dict_write_begin(&out, buffer, sizeof(buffer));
+	dict_write_uint8(&out, HTTP_URL_KEY, 1);
+	dict_write_int16(&out, HTTP_STATUS_KEY, 200);
+	dict_write_int32(&out, HTTP_COOKIE_KEY, cookie ? cookie->value->int32 : 0);
+	dict_write_int32(&out, HTTP_APP_ID_KEY, app_id ? app_id->value->int32 : 0);
+	if (nonce) dict_write_int16(&out, CHECKDIGITS, (int16_t)int_value(nonce));
+
+	if (known && (uint32_t)int_value(known) == version) {
+		stats.not_modified++;
+		dict_write_uint8(&out, NOT_MODIFIED, 1);
+	}
+	else {
+		bool vibrate = content.unread_email > last_unread_email;
+		last_unread_email = content.unread_email;
+		if (packed && int_value(packed) == STATUS_BOARD_PACKED_VERSION) {
+			write_packed(&out, &content, vibrate);
+		}
+		else {
+			write_tuples(&out, &content, vibrate);
+		}
+	}
+	reply(&out, buffer, BRIDGE_HTTP_MS);
+}
+
+static void answer_location() {
+	uint8_t buffer[BRIDGE_MESSAGE_MAX];
+	DictionaryIterator out;
+	stats.location_requests++;
+	dict_write_begin(&out, buffer, sizeof(buffer));
+	dict_write_uint32(&out, HTTP_LOCATION_KEY, float_bits(BRIDGE_ACCURACY));
+	dict_write_uint32(&out, HTTP_LATITUDE_KEY, float_bits(BRIDGE_LATITUDE));
+	dict_write_uint32(&out, HTTP_LONGITUDE_KEY, float_bits(BRIDGE_LONGITUDE));
+	dict_write_uint32(&out, HTTP_ALTITUDE_KEY, float_bits(BRIDGE_ALTITUDE));
+	reply(&out, buffer, BRIDGE_LOCATION_MS);
+}
+
+static void answer_time() {
+	uint8_t buffer[BRIDGE_MESSAGE_MAX];
+	DictionaryIterator out;
+	stats.time_requests++;
+	dict_write_begin(&out, buffer, sizeof(buffer));
+	dict_write_uint32(&out, HTTP_TIME_KEY, (uint32_t)time(NULL));
+	dict_write_int32(&out, HTTP_UTC_OFFSET_KEY, 0);
+	dict_write_uint8(&out, HTTP_IS_DST_KEY, 0);
+	dict_write_cstring(&out, HTTP_TZ_NAME_KEY, "UTC");
+	reply(&out, buffer, BRIDGE_LOCAL_MS);
+}
+
+static BridgeCookie* cookie_find(int32_t app_id, uint32_t key) {
+	for (int i = 0; i < BRIDGE_COOKIE_CAPACITY; i++) {
+		if (cookies[i].in_use && cookies[i].app_id == app_id && cookies[i].key == key) return &cookies[i];
+	}
+	return NULL;
+}
+
+static void cookie_store(int32_t app_id, const Tuple* tuple) {
+	BridgeCookie* cookie = cookie_find(app_id, tuple->key);
+	for (int i = 0; !cookie && i < BRIDGE_COOKIE_CAPACITY; i++) {
+		if (!cookies[i].in_use) cookie = &cookies[i];
+	}
+	if (!cookie || tuple->length > HTTP_QUEUE_VALUE_MAX) return;
+	*cookie = (BridgeCookie){
+		.in_use = true,
+		.app_id = app_id,
+		.key = tuple->key,
+		.type = tuple->type,
+		.length = tuple->length
+	};
+	memcpy(cookie->value, tuple->value->data, tuple->length);
+}
+
+static bool reserved(uint32_t key) {
+	return key >= 0xF000 && key <= 0xFFFF;
+}
+
+// Cookie operations answer with the operation key and the app id, plus the
+// stored values for a load.
+static void answer_cookie(DictionaryIterator* request, uint32_t operation, Tuple* request_id) {
+	uint8_t buffer[BRIDGE_MESSAGE_MAX];
+	DictionaryIterator out;
+	Tuple* app_id_tuple = dict_find(request, HTTP_APP_ID_KEY);
+	int32_t app_id = app_id_tuple ? app_id_tuple->value->int32 : 0;
+	stats.cookie_requests++;
+
+	dict_write_begin(&out, buffer, sizeof(buffer));
+	if (operation == HTTP_COOKIE_FSYNC_KEY) {
+		dict_write_uint8(&out, operation, 1);
+	}
+	else {
+		dict_write_int32(&out, operation, request_id->value->int32);
+	}
+	dict_write_int32(&out, HTTP_APP_ID_KEY, app_id);
+
+	for (Tuple* tuple = dict_read_first(request); tuple; tuple = dict_read_next(request)) {
+		if (reserved(tuple->key)) continue;
+		if (operation == HTTP_COOKIE_STORE_KEY) {
+			cookie_store(app_id, tuple);
+		}
+		else if (operation == HTTP_COOKIE_DELETE_KEY) {
+			BridgeCookie* cookie = cookie_find(app_id, tuple->key);
+			if (cookie) cookie->in_use = false;
+		}
+		else if (operation == HTTP_COOKIE_LOAD_KEY) {
+			BridgeCookie* cookie = cookie_find(app_id, tuple->key);
+			if (!cookie) continue;
+			if (cookie->type == TUPLE_INT || cookie->type == TUPLE_UINT) {
+				dict_write_int(&out, cookie->key, cookie->value, cookie->length, cookie->type == TUPLE_INT);
+			}
+			else {
+				dict_write_data(&out, cookie->key, cookie->value, cookie->length);
+			}
+		}
+	}
+	reply(&out, buffer, BRIDGE_LOCAL_MS);
+}
+
+void host_bridge_receive(DictionaryIterator* message) {
+	static const uint32_t COOKIE_OPERATIONS[] = {
+		HTTP_COOKIE_LOAD_KEY, HTTP_COOKIE_STORE_KEY, HTTP_COOKIE_DELETE_KEY, HTTP_COOKIE_FSYNC_KEY
+	};
+	if (dict_find(message, HTTP_URL_KEY)) {
+		answer_data(message);
+		return;
+	}
+	if (dict_find(message, HTTP_LOCATION_KEY)) {
+		answer_location();
+		return;
+	}
+	if (dict_find(message, HTTP_TIME_KEY)) {
+		answer_time();
+		return;
+	}
+	for (unsigned i = 0; i < sizeof(COOKIE_OPERATIONS) / sizeof(COOKIE_OPERATIONS[0]); i++) {
+		Tuple* request_id = dict_find(message, COOKIE_OPERATIONS[i]);
+		if (request_id) {
+			answer_cookie(message, COOKIE_OPERATIONS[i], request_id);
+			return;
+		}
+	}
+	stats.other++;
+}
+
+void host_bridge_set_connected(bool now_connected) {
+	if (now_connected && !connected) {
+		uint8_t buffer[BRIDGE_MESSAGE_MAX];
+		DictionaryIterator out;
+		dict_write_begin(&out, buffer, sizeof(buffer));
+		dict_write_uint8(&out, HTTP_CONNECT_KEY, 1);
+		reply(&out, buffer, BRIDGE_RECONNECT_MS);
+	}
+	connected = now_connected;
+}
+
+bool host_bridge_connected() {
+	return connected;
+}
+
+const BridgeStats* host_bridge_stats() {
+	return &stats;
+}
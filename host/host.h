@@ -0,0 +1,78 @@
+#ifndef HOST_H
+#define HOST_H
+
+// Glue between the stand-in SDK (pebble_shim.c), the phone side of the
+// AppMessage link (bridge.c) and the drivers that play scenarios against
+// the app. Time on the host is a fake millisecond clock that only moves
+// when a driver moves it, so every run sees the same timers, messages and
+// ticks.
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+
+#define HOST_MS_PER_MINUTE (60 * 1000)
+
+// Unix time of clock zero: midnight, Saturday 5 October 2013 (UTC)
+#define HOST_EPOCH 1380931200
+
+// Link timing. A send is acked, or fails with APP_MSG_SEND_TIMEOUT while the
+// phone is out of reach, this long after app_message_out_send.
+#define HOST_ACK_MS 50
+#define HOST_SEND_TIMEOUT_MS 1500
+
+// The app's entry point, defined in main.c
+void pbl_main(void* params);
+
+// Set by a driver before calling pbl_main. app_event_loop runs it between
+// init and deinit; without one the app is initialised and torn down.
+extern void (*host_driver)(const PebbleAppHandlers* handlers);
+
+// Milliseconds since HOST_EPOCH
+uint64_t host_now();
+
+// Runs every timer, ack and inbound message due before ms, in order,
+// redrawing after each like the firmware's event loop. Leaves the clock at
+// ms.
+void host_run_until(uint64_t ms);
+
+// Delivers a minute tick for the current clock to the app's tick handler
+void host_tick();
+
+typedef struct {
+	uint32_t frames;		// redraws of the window
+	uint32_t layers_drawn;	// update_procs run across all frames
+	uint32_t timers;
+	uint32_t messages_out;
+	uint32_t bytes_out;
+	uint32_t send_failures;
+	uint32_t messages_in;
+	uint32_t bytes_in;
+	uint32_t inbound_dropped;	// too big for the app's inbound buffer
+} HostStats;
+
+const HostStats* host_stats();
+
+// Queues a message from the phone for delivery in delay_ms
+void host_inbox_push(const uint8_t* data, uint16_t size, uint32_t delay_ms);
+
+// Phone side. host_bridge_receive gets each message the watch sends while
+// the phone is in reach, as it is acked; replies go through host_inbox_push.
+void host_bridge_receive(DictionaryIterator* message);
+
+// Takes the phone out of reach or brings it back. Coming back announces the
+// reconnect to the app like the httpebble bridge does.
+void host_bridge_set_connected(bool connected);
+bool host_bridge_connected();
+
+typedef struct {
+	uint32_t data_requests;
+	uint32_t not_modified;
+	uint32_t location_requests;
+	uint32_t cookie_requests;
+	uint32_t time_requests;
+	uint32_t other;
+} BridgeStats;
+
+const BridgeStats* host_bridge_stats();
+
+#endif // HOST_H
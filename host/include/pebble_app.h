@@ -0,0 +1,55 @@
+#ifndef PEBBLE_APP_H
+#define PEBBLE_APP_H
+
+// Stand-in for the SDK 1.x app header on the host build.
+
+#include "pebble_os.h"
+#include "resource_ids.auto.h"
+
+typedef void* AppContextRef;
+typedef void* AppTaskContextRef;
+typedef uint32_t AppTimerHandle;
+
+typedef struct {
+	PblTm* tick_time;
+	TimeUnits units_changed;
+} PebbleTickEvent;
+
+typedef void (*PebbleAppInitEventHandler)(AppContextRef app_ctx);
+typedef void (*PebbleAppDeinitEventHandler)(AppContextRef app_ctx);
+typedef void (*PebbleAppTimerHandler)(AppContextRef app_ctx, AppTimerHandle handle, uint32_t cookie);
+typedef void (*PebbleAppTickHandler)(AppContextRef app_ctx, PebbleTickEvent* event);
+
+typedef struct {
+	PebbleAppTickHandler tick_handler;
+	TimeUnits tick_units;
+} PebbleAppTickInfo;
+
+typedef struct {
+	struct {
+		uint16_t inbound;
+		uint16_t outbound;
+	} buffer_sizes;
+} PebbleAppMessagingInfo;
+
+typedef struct {
+	PebbleAppInitEventHandler init_handler;
+	PebbleAppDeinitEventHandler deinit_handler;
+	PebbleAppTimerHandler timer_handler;
+	PebbleAppTickInfo tick_info;
+	PebbleAppMessagingInfo messaging_info;
+} PebbleAppHandlers;
+
+// Runs init, then whatever the host driver plays, then deinit
+void app_event_loop(AppTaskContextRef app_task_ctx, PebbleAppHandlers* handlers);
+
+AppTimerHandle app_timer_send_event(AppContextRef app_ctx, uint32_t timeout_ms, uint32_t cookie);
+bool app_timer_cancel_event(AppContextRef app_ctx_ref, AppTimerHandle handle);
+
+#define APP_INFO_STANDARD_APP 0
+#define APP_INFO_WATCH_FACE 1
+
+// The app info block only matters to the firmware's launcher
+#define PBL_APP_INFO(uuid, name, company, version_major, version_minor, icon, type)
+
+#endif // PEBBLE_APP_H
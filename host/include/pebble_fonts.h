@@ -0,0 +1,15 @@
+#ifndef PEBBLE_FONTS_H
+#define PEBBLE_FONTS_H
+
+// System font keys, for fonts_get_system_font on the host build
+
+#define FONT_KEY_GOTHIC_14 "RESOURCE_ID_GOTHIC_14"
+#define FONT_KEY_GOTHIC_14_BOLD "RESOURCE_ID_GOTHIC_14_BOLD"
+#define FONT_KEY_GOTHIC_18 "RESOURCE_ID_GOTHIC_18"
+#define FONT_KEY_GOTHIC_18_BOLD "RESOURCE_ID_GOTHIC_18_BOLD"
+#define FONT_KEY_GOTHIC_24 "RESOURCE_ID_GOTHIC_24"
+#define FONT_KEY_GOTHIC_24_BOLD "RESOURCE_ID_GOTHIC_24_BOLD"
+#define FONT_KEY_GOTHIC_28 "RESOURCE_ID_GOTHIC_28"
+#define FONT_KEY_GOTHIC_28_BOLD "RESOURCE_ID_GOTHIC_28_BOLD"
+
+#endif // PEBBLE_FONTS_H
@@ -0,0 +1,320 @@
+#ifndef PEBBLE_OS_H
+#define PEBBLE_OS_H
+
+// Stand-in for the SDK 1.x header on the host build. Types follow the SDK
+// layouts closely enough for the app to compile unchanged; everything
+// declared here is implemented by pebble_shim.c.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Geometry
+typedef struct {
+	int16_t x;
+	int16_t y;
+} GPoint;
+
+typedef struct {
+	int16_t w;
+	int16_t h;
+} GSize;
+
+typedef struct {
+	GPoint origin;
+	GSize size;
+} GRect;
+
+#define GPoint(x, y) ((GPoint){(x), (y)})
+#define GSize(w, h) ((GSize){(w), (h)})
+#define GRect(x, y, w, h) ((GRect){{(x), (y)}, {(w), (h)}})
+
+bool grect_equal(const GRect* const rect_a, const GRect* const rect_b);
+
+// Graphics
+typedef enum {
+	GColorClear = ~0,
+	GColorBlack = 0,
+	GColorWhite = 1,
+} GColor;
+
+typedef enum {
+	GTextAlignmentLeft,
+	GTextAlignmentCenter,
+	GTextAlignmentRight
+} GTextAlignment;
+
+typedef enum {
+	GTextOverflowModeWordWrap,
+	GTextOverflowModeTrailingEllipsis
+} GTextOverflowMode;
+
+typedef enum {
+	GCornerNone = 0,
+	GCornersAll = 15
+} GCornerMask;
+
+typedef enum {
+	GCompOpAssign,
+	GCompOpAssignInverted,
+	GCompOpOr,
+	GCompOpAnd,
+	GCompOpClear
+} GCompOp;
+
+typedef struct GContext GContext;
+typedef void* GFont;
+typedef void* GTextLayoutCacheRef;
+
+typedef struct {
+	void* addr;
+	uint16_t row_size_bytes;
+	uint16_t info_flags;
+	GRect bounds;
+} GBitmap;
+
+void gbitmap_init_as_sub_bitmap(GBitmap* sub_bitmap, const GBitmap* base_bitmap, GRect sub_rect);
+
+void graphics_context_set_fill_color(GContext* ctx, GColor color);
+void graphics_context_set_text_color(GContext* ctx, GColor color);
+void graphics_fill_rect(GContext* ctx, GRect rect, uint8_t corner_radius, GCornerMask corner_mask);
+void graphics_draw_bitmap_in_rect(GContext* ctx, const GBitmap* bitmap, GRect rect);
+void graphics_text_draw(GContext* ctx, const char* text, const GFont font, const GRect box,
+	const GTextOverflowMode overflow_mode, const GTextAlignment alignment, const GTextLayoutCacheRef layout);
+GSize graphics_text_layout_get_max_used_size(GContext* ctx, const char* text, const GFont font, const GRect box,
+	const GTextOverflowMode overflow_mode, const GTextAlignment alignment, GTextLayoutCacheRef layout);
+
+// Layers
+struct Layer;
+struct Window;
+typedef void (*LayerUpdateProc)(struct Layer* layer, GContext* ctx);
+
+typedef struct Layer {
+	GRect bounds;
+	GRect frame;
+	bool clips : 1;
+	bool hidden : 1;
+	struct Layer* next_sibling;
+	struct Layer* parent;
+	struct Layer* first_child;
+	struct Window* window;
+	LayerUpdateProc update_proc;
+} Layer;
+
+void layer_init(Layer* layer, GRect frame);
+void layer_mark_dirty(Layer* layer);
+void layer_add_child(Layer* parent, Layer* child);
+void layer_remove_from_parent(Layer* child);
+void layer_set_frame(Layer* layer, GRect frame);
+GRect layer_get_frame(Layer* layer);
+void layer_set_bounds(Layer* layer, GRect bounds);
+GRect layer_get_bounds(Layer* layer);
+void layer_set_hidden(Layer* layer, bool hidden);
+
+typedef struct {
+	Layer layer;
+	const char* text;
+	GFont font;
+	GTextLayoutCacheRef layout_cache;
+	GColor text_color : 2;
+	GColor background_color : 2;
+	GTextOverflowMode overflow_mode : 2;
+	GTextAlignment text_alignment : 2;
+} TextLayer;
+
+void text_layer_init(TextLayer* text_layer, GRect frame);
+void text_layer_set_text(TextLayer* text_layer, const char* text);
+void text_layer_set_font(TextLayer* text_layer, GFont font);
+void text_layer_set_text_alignment(TextLayer* text_layer, GTextAlignment text_alignment);
+void text_layer_set_background_color(TextLayer* text_layer, GColor color);
+void text_layer_set_text_color(TextLayer* text_layer, GColor color);
+
+typedef struct {
+	Layer layer;
+	const GBitmap* bitmap;
+	GColor background_color : 2;
+	GCompOp compositing_mode : 3;
+} BitmapLayer;
+
+void bitmap_layer_init(BitmapLayer* image, GRect frame);
+void bitmap_layer_set_bitmap(BitmapLayer* image, const GBitmap* bitmap);
+void bitmap_layer_set_background_color(BitmapLayer* image, GColor color);
+
+typedef struct {
+	BitmapLayer layer;
+	GBitmap bmp;
+	uint8_t* data;
+} BmpContainer;
+
+bool bmp_init_container(int resource_id, BmpContainer* c);
+void bmp_deinit_container(BmpContainer* c);
+
+// Windows
+typedef struct Window {
+	Layer layer;
+	const char* debug_name;
+	GColor background_color : 2;
+} Window;
+
+void window_init(Window* window, const char* debug_name);
+void window_stack_push(Window* window, bool animated);
+void window_set_background_color(Window* window, GColor background_color);
+
+// Resources and fonts
+typedef struct {
+	uint32_t crc;
+	uint32_t timestamp;
+	const char* friendly_version;
+} ResBankVersion;
+
+typedef const ResBankVersion* ResVersionHandle;
+typedef uint32_t ResHandle;
+
+void resource_init_current_app(ResVersionHandle version);
+ResHandle resource_get_handle(uint32_t file_id);
+
+GFont fonts_load_custom_font(ResHandle resource);
+void fonts_unload_custom_font(GFont font);
+GFont fonts_get_system_font(const char* font_key);
+
+// Time
+typedef struct {
+	int tm_sec;
+	int tm_min;
+	int tm_hour;
+	int tm_mday;
+	int tm_mon;
+	int tm_year;
+	int tm_wday;
+	int tm_yday;
+	int tm_isdst;
+} PblTm;
+
+typedef enum {
+	SECOND_UNIT = 1 << 0,
+	MINUTE_UNIT = 1 << 1,
+	HOUR_UNIT = 1 << 2,
+	DAY_UNIT = 1 << 3,
+	MONTH_UNIT = 1 << 4,
+	YEAR_UNIT = 1 << 5
+} TimeUnits;
+
+void get_time(PblTm* time);
+void string_format_time(char* ptr, size_t maxsize, const char* format, const PblTm* timeptr);
+bool clock_is_24h_style(void);
+
+void vibes_short_pulse(void);
+
+// Dictionaries, in the AppMessage wire format: a one byte tuple count, then
+// each tuple as a 7 byte header followed by its value.
+typedef enum {
+	TUPLE_BYTE_ARRAY = 0,
+	TUPLE_CSTRING = 1,
+	TUPLE_UINT = 2,
+	TUPLE_INT = 3
+} TupleType;
+
+typedef struct __attribute__((__packed__)) {
+	uint32_t key;
+	TupleType type : 8;
+	uint16_t length;
+	union {
+		uint8_t data[0];
+		char cstring[0];
+		uint8_t uint8;
+		uint16_t uint16;
+		uint32_t uint32;
+		int8_t int8;
+		int16_t int16;
+		int32_t int32;
+	} value[];
+} Tuple;
+
+typedef struct Dictionary Dictionary;
+
+typedef struct {
+	Dictionary* dictionary;
+	const void* end;
+	Tuple* cursor;
+} DictionaryIterator;
+
+typedef enum {
+	DICT_OK = 0,
+	DICT_NOT_ENOUGH_STORAGE = 1 << 1,
+	DICT_INVALID_ARGS = 1 << 2,
+	DICT_INTERNAL_INCONSISTENCY = 1 << 3
+} DictionaryResult;
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...);
+DictionaryResult dict_write_begin(DictionaryIterator* iter, uint8_t* const buffer, const uint16_t size);
+DictionaryResult dict_write_data(DictionaryIterator* iter, const uint32_t key, const uint8_t* const data, const uint16_t size);
+DictionaryResult dict_write_cstring(DictionaryIterator* iter, const uint32_t key, const char* const cstring);
+DictionaryResult dict_write_int(DictionaryIterator* iter, const uint32_t key, const void* integer, const uint8_t width_bytes, const bool is_signed);
+DictionaryResult dict_write_uint8(DictionaryIterator* iter, const uint32_t key, const uint8_t value);
+DictionaryResult dict_write_uint16(DictionaryIterator* iter, const uint32_t key, const uint16_t value);
+DictionaryResult dict_write_uint32(DictionaryIterator* iter, const uint32_t key, const uint32_t value);
+DictionaryResult dict_write_int8(DictionaryIterator* iter, const uint32_t key, const int8_t value);
+DictionaryResult dict_write_int16(DictionaryIterator* iter, const uint32_t key, const int16_t value);
+DictionaryResult dict_write_int32(DictionaryIterator* iter, const uint32_t key, const int32_t value);
+uint32_t dict_write_end(DictionaryIterator* iter);
+Tuple* dict_read_begin_from_buffer(DictionaryIterator* iter, const uint8_t* const buffer, const uint16_t size);
+Tuple* dict_read_first(DictionaryIterator* iter);
+Tuple* dict_read_next(DictionaryIterator* iter);
+Tuple* dict_find(const DictionaryIterator* iter, const uint32_t key);
+
+// AppMessage
+typedef enum {
+	APP_MSG_OK = 0,
+	APP_MSG_SEND_TIMEOUT = 1 << 1,
+	APP_MSG_SEND_REJECTED = 1 << 2,
+	APP_MSG_NOT_CONNECTED = 1 << 3,
+	APP_MSG_APP_NOT_RUNNING = 1 << 4,
+	APP_MSG_INVALID_ARGS = 1 << 5,
+	APP_MSG_BUSY = 1 << 6,
+	APP_MSG_BUFFER_OVERFLOW = 1 << 7,
+	APP_MSG_ALREADY_RELEASED = 1 << 9,
+	APP_MSG_CALLBACK_ALREADY_REGISTERED = 1 << 10,
+	APP_MSG_CALLBACK_NOT_REGISTERED = 1 << 11
+} AppMessageResult;
+
+typedef void (*AppMessageSentCallback)(DictionaryIterator* sent, void* context);
+typedef void (*AppMessageFailedCallback)(DictionaryIterator* failed, AppMessageResult reason, void* context);
+typedef void (*AppMessageReceivedCallback)(DictionaryIterator* received, void* context);
+typedef void (*AppMessageDroppedCallback)(void* context, AppMessageResult reason);
+
+typedef struct {
+	AppMessageSentCallback out_sent;
+	AppMessageFailedCallback out_failed;
+	AppMessageReceivedCallback in_received;
+	AppMessageDroppedCallback in_dropped;
+} AppMessageCallbacks;
+
+typedef struct AppMessageCallbacksNode {
+	struct AppMessageCallbacksNode* node;
+	void* context;
+	AppMessageCallbacks callbacks;
+} AppMessageCallbacksNode;
+
+AppMessageResult app_message_register_callbacks(AppMessageCallbacksNode* callbacks_node);
+AppMessageResult app_message_deregister_callbacks(AppMessageCallbacksNode* callbacks_node);
+AppMessageResult app_message_out_get(DictionaryIterator** iter_out);
+AppMessageResult app_message_out_send(void);
+AppMessageResult app_message_out_release(void);
+
+// Logging
+typedef enum {
+	APP_LOG_LEVEL_ERROR = 1,
+	APP_LOG_LEVEL_WARNING = 50,
+	APP_LOG_LEVEL_INFO = 100,
+	APP_LOG_LEVEL_DEBUG = 200,
+	APP_LOG_LEVEL_DEBUG_VERBOSE = 255
+} AppLogLevel;
+
+void app_log(uint8_t log_level, const char* src_filename, int src_line_number, const char* fmt, ...);
+
+#define APP_LOG(level, fmt, args...) app_log(level, __FILE__, __LINE__, fmt, ## args)
+
+#endif // PEBBLE_OS_H
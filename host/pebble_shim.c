@@ -0,0 +1,769 @@
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "host.h"
+
+// The SDK surface the app uses, run on the fake clock. Drawing walks the
+// layer tree and calls every update_proc but puts no pixels anywhere; the
+// AppMessage link hands outbound messages to bridge.c and queues its
+// replies. Nothing here includes perf.h, so the app's counters only see the
+// app's own calls, as on the watch.
+
+static PebbleAppHandlers app_handlers;
+static int app_context;
+static uint64_t now_ms;
+static uint32_t event_sequence;
+static HostStats stats;
+
+void (*host_driver)(const PebbleAppHandlers* handlers);
+
+uint64_t host_now() {
+	return now_ms;
+}
+
+const HostStats* host_stats() {
+	return &stats;
+}
+
+// The app reads the fake clock through time() like any other caller, so the
+// definition here takes the place of the C library's.
+time_t time(time_t* t) {
+	time_t now = HOST_EPOCH + (time_t)(now_ms / 1000);
+	if (t) *t = now;
+	return now;
+}
+
+// Stand-in for the DWT cycle counter perf.c reads on the watch: nanoseconds
+// of the monotonic clock, which wrap the same way.
+void perf_cycles_init() {
+}
+
+uint32_t perf_cycles() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+}
+
+// Geometry
+bool grect_equal(const GRect* const rect_a, const GRect* const rect_b) {
+	return rect_a->origin.x == rect_b->origin.x && rect_a->origin.y == rect_b->origin.y &&
+		rect_a->size.w == rect_b->size.w && rect_a->size.h == rect_b->size.h;
+}
+
+// Graphics. The context only carries colours; draws are counted by the
+// layer walk, not here.
+struct GContext {
+	GColor fill_color;
+	GColor text_color;
+};
+
+void graphics_context_set_fill_color(GContext* ctx, GColor color) {
+	ctx->fill_color = color;
+}
+
+void graphics_context_set_text_color(GContext* ctx, GColor color) {
+	ctx->text_color = color;
+}
+
+void graphics_fill_rect(GContext* ctx, GRect rect, uint8_t corner_radius, GCornerMask corner_mask) {
+}
+
+void graphics_draw_bitmap_in_rect(GContext* ctx, const GBitmap* bitmap, GRect rect) {
+}
+
+// Shares the base's pixels; the bounds are sub_rect, taken from the base's
+// origin and clipped to the base like the firmware does.
+void gbitmap_init_as_sub_bitmap(GBitmap* sub_bitmap, const GBitmap* base_bitmap, GRect sub_rect) {
+	GRect base = base_bitmap->bounds;
+	int16_t x0 = base.origin.x + sub_rect.origin.x, y0 = base.origin.y + sub_rect.origin.y;
+	int16_t x1 = x0 + sub_rect.size.w, y1 = y0 + sub_rect.size.h;
+	if (x0 < base.origin.x) x0 = base.origin.x;
+	if (y0 < base.origin.y) y0 = base.origin.y;
+	if (x1 > base.origin.x + base.size.w) x1 = base.origin.x + base.size.w;
+	if (y1 > base.origin.y + base.size.h) y1 = base.origin.y + base.size.h;
+	*sub_bitmap = *base_bitmap;
+	sub_bitmap->bounds = GRect(x0, y0, x1 > x0 ? x1 - x0 : 0, y1 > y0 ? y1 - y0 : 0);
+}
+
+void graphics_text_draw(GContext* ctx, const char* text, const GFont font, const GRect box,
+	const GTextOverflowMode overflow_mode, const GTextAlignment alignment, const GTextLayoutCacheRef layout) {
+}
+
+// Without font metrics, every glyph is taken to be half as wide as the box
+// is tall, which is close enough for layout code to take its normal paths.
+GSize graphics_text_layout_get_max_used_size(GContext* ctx, const char* text, const GFont font, const GRect box,
+	const GTextOverflowMode overflow_mode, const GTextAlignment alignment, GTextLayoutCacheRef layout) {
+	int16_t w = (int16_t)(strlen(text) * (box.size.h / 2));
+	return GSize(w < box.size.w ? w : box.size.w, box.size.h);
+}
+
+// Layers
+static Window* top_window;
+static bool dirty;
+
+void layer_init(Layer* layer, GRect frame) {
+	memset(layer, 0, sizeof(Layer));
+	layer->frame = frame;
+	layer->bounds = GRect(0, 0, frame.size.w, frame.size.h);
+	layer->clips = true;
+}
+
+void layer_mark_dirty(Layer* layer) {
+	dirty = true;
+}
+
+void layer_add_child(Layer* parent, Layer* child) {
+	if (child->parent) layer_remove_from_parent(child);
+	child->parent = parent;
+	child->window = parent->window;
+	child->next_sibling = NULL;
+	Layer** link = &parent->first_child;
+	while (*link) link = &(*link)->next_sibling;
+	*link = child;
+	dirty = true;
+}
+
+void layer_remove_from_parent(Layer* child) {
+	if (!child->parent) return;
+	Layer** link = &child->parent->first_child;
+	while (*link && *link != child) link = &(*link)->next_sibling;
+	if (*link) *link = child->next_sibling;
+	child->parent = NULL;
+	child->next_sibling = NULL;
+	dirty = true;
+}
+
+void layer_set_frame(Layer* layer, GRect frame) {
+	layer->frame = frame;
+	layer->bounds.size = frame.size;
+	dirty = true;
+}
+
+GRect layer_get_frame(Layer* layer) {
+	return layer->frame;
+}
+
+void layer_set_bounds(Layer* layer, GRect bounds) {
+	layer->bounds = bounds;
+	dirty = true;
+}
+
+GRect layer_get_bounds(Layer* layer) {
+	return layer->bounds;
+}
+
+void layer_set_hidden(Layer* layer, bool hidden) {
+	if (layer->hidden == hidden) return;
+	layer->hidden = hidden;
+	dirty = true;
+}
+
+static void draw_layer(Layer* layer, GContext* ctx) {
+	if (layer->hidden) return;
+	if (layer->update_proc) {
+		stats.layers_drawn++;
+		layer->update_proc(layer, ctx);
+	}
+	for (Layer* child = layer->first_child; child; child = child->next_sibling) {
+		draw_layer(child, ctx);
+	}
+}
+
+// The firmware redraws the whole window once an event has marked anything
+// dirty.
+static void render() {
+	if (!dirty || !top_window) return;
+	dirty = false;
+	stats.frames++;
+	GContext ctx = { GColorBlack, GColorWhite };
+	draw_layer(&top_window->layer, &ctx);
+}
+
+// Text layers
+static void text_layer_draw(Layer* layer, GContext* ctx) {
+	TextLayer* text_layer = (TextLayer*)layer;
+	if (text_layer->background_color != GColorClear) {
+		graphics_context_set_fill_color(ctx, text_layer->background_color);
+		graphics_fill_rect(ctx, layer->bounds, 0, GCornerNone);
+	}
+	if (!text_layer->text) return;
+	graphics_context_set_text_color(ctx, text_layer->text_color);
+	graphics_text_draw(ctx, text_layer->text, text_layer->font, layer->bounds,
+		text_layer->overflow_mode, text_layer->text_alignment, text_layer->layout_cache);
+}
+
+void text_layer_init(TextLayer* text_layer, GRect frame) {
+	memset(text_layer, 0, sizeof(TextLayer));
+	layer_init(&text_layer->layer, frame);
+	text_layer->layer.update_proc = text_layer_draw;
+	text_layer->text_color = GColorBlack;
+	text_layer->background_color = GColorWhite;
+	text_layer->overflow_mode = GTextOverflowModeWordWrap;
+	text_layer->text_alignment = GTextAlignmentLeft;
+	text_layer->font = fonts_get_system_font("RESOURCE_ID_GOTHIC_14_BOLD");
+}
+
+void text_layer_set_text(TextLayer* text_layer, const char* text) {
+	text_layer->text = text;
+	dirty = true;
+}
+
+void text_layer_set_font(TextLayer* text_layer, GFont font) {
+	text_layer->font = font;
+	dirty = true;
+}
+
+void text_layer_set_text_alignment(TextLayer* text_layer, GTextAlignment text_alignment) {
+	text_layer->text_alignment = text_alignment;
+	dirty = true;
+}
+
+void text_layer_set_background_color(TextLayer* text_layer, GColor color) {
+	text_layer->background_color = color;
+	dirty = true;
+}
+
+void text_layer_set_text_color(TextLayer* text_layer, GColor color) {
+	text_layer->text_color = color;
+	dirty = true;
+}
+
+// Bitmap layers
+static void bitmap_layer_draw(Layer* layer, GContext* ctx) {
+	BitmapLayer* image = (BitmapLayer*)layer;
+	if (image->background_color != GColorClear) {
+		graphics_context_set_fill_color(ctx, image->background_color);
+		graphics_fill_rect(ctx, layer->bounds, 0, GCornerNone);
+	}
+	if (image->bitmap) {
+		graphics_draw_bitmap_in_rect(ctx, image->bitmap, layer->bounds);
+	}
+}
+
+void bitmap_layer_init(BitmapLayer* image, GRect frame) {
+	memset(image, 0, sizeof(BitmapLayer));
+	layer_init(&image->layer, frame);
+	image->layer.update_proc = bitmap_layer_draw;
+	image->background_color = GColorClear;
+	image->compositing_mode = GCompOpAssign;
+}
+
+void bitmap_layer_set_bitmap(BitmapLayer* image, const GBitmap* bitmap) {
+	image->bitmap = bitmap;
+	dirty = true;
+}
+
+void bitmap_layer_set_background_color(BitmapLayer* image, GColor color) {
+	image->background_color = color;
+	dirty = true;
+}
+
+// The firmware decodes a PNG resource into a 1-bit bitmap with word-aligned
+// rows on the app heap. The size comes from the image's IHDR chunk.
+static bool png_size(const char* file, GSize* size) {
+	char path[256];
+	uint8_t header[24];
+	snprintf(path, sizeof(path), "%s/%s", HOST_RESOURCE_DIR, file);
+	FILE* f = fopen(path, "rb");
+	if (!f) return false;
+	size_t read = fread(header, 1, sizeof(header), f);
+	fclose(f);
+	if (read != sizeof(header) || memcmp(&header[12], "IHDR", 4) != 0) return false;
+	size->w = (int16_t)((header[16] << 24) | (header[17] << 16) | (header[18] << 8) | header[19]);
+	size->h = (int16_t)((header[20] << 24) | (header[21] << 16) | (header[22] << 8) | header[23]);
+	return true;
+}
+
+bool bmp_init_container(int resource_id, BmpContainer* c) {
+	GSize size;
+	if (resource_id <= INVALID_RESOURCE || resource_id >= RESOURCE_COUNT ||
+		!png_size(host_resource_files[resource_id], &size)) {
+		return false;
+	}
+	memset(c, 0, sizeof(BmpContainer));
+	c->bmp.row_size_bytes = ((size.w + 31) / 32) * 4;
+	c->bmp.bounds = GRect(0, 0, size.w, size.h);
+	c->data = calloc(c->bmp.row_size_bytes, size.h);
+	c->bmp.addr = c->data;
+	bitmap_layer_init(&c->layer, c->bmp.bounds);
+	bitmap_layer_set_bitmap(&c->layer, &c->bmp);
+	return c->data != NULL;
+}
+
+void bmp_deinit_container(BmpContainer* c) {
+	free(c->data);
+	c->data = NULL;
+	c->bmp.addr = NULL;
+}
+
+// Windows
+static void window_draw(Layer* layer, GContext* ctx) {
+	Window* window = (Window*)layer;
+	if (window->background_color == GColorClear) return;
+	graphics_context_set_fill_color(ctx, window->background_color);
+	graphics_fill_rect(ctx, layer->bounds, 0, GCornerNone);
+}
+
+void window_init(Window* window, const char* debug_name) {
+	memset(window, 0, sizeof(Window));
+	layer_init(&window->layer, GRect(0, 0, 144, 168));
+	window->layer.window = window;
+	window->layer.update_proc = window_draw;
+	window->debug_name = debug_name;
+	window->background_color = GColorWhite;
+}
+
+void window_stack_push(Window* window, bool animated) {
+	top_window = window;
+	dirty = true;
+}
+
+void window_set_background_color(Window* window, GColor background_color) {
+	window->background_color = background_color;
+	dirty = true;
+}
+
+// Resources and fonts. Handles are only compared, never dereferenced, so a
+// font is its resource id.
+void resource_init_current_app(ResVersionHandle version) {
+}
+
+ResHandle resource_get_handle(uint32_t file_id) {
+	return file_id;
+}
+
+GFont fonts_load_custom_font(ResHandle resource) {
+	return (GFont)(uintptr_t)resource;
+}
+
+void fonts_unload_custom_font(GFont font) {
+}
+
+GFont fonts_get_system_font(const char* font_key) {
+	return (GFont)font_key;
+}
+
+// Time
+static void to_tm(const PblTm* pbl, struct tm* tm) {
+	memset(tm, 0, sizeof(struct tm));
+	tm->tm_sec = pbl->tm_sec;
+	tm->tm_min = pbl->tm_min;
+	tm->tm_hour = pbl->tm_hour;
+	tm->tm_mday = pbl->tm_mday;
+	tm->tm_mon = pbl->tm_mon;
+	tm->tm_year = pbl->tm_year;
+	tm->tm_wday = pbl->tm_wday;
+	tm->tm_yday = pbl->tm_yday;
+	tm->tm_isdst = pbl->tm_isdst;
+}
+
+void get_time(PblTm* pbl) {
+	time_t now = time(NULL);
+	struct tm tm;
+	gmtime_r(&now, &tm);
+	pbl->tm_sec = tm.tm_sec;
+	pbl->tm_min = tm.tm_min;
+	pbl->tm_hour = tm.tm_hour;
+	pbl->tm_mday = tm.tm_mday;
+	pbl->tm_mon = tm.tm_mon;
+	pbl->tm_year = tm.tm_year;
+	pbl->tm_wday = tm.tm_wday;
+	pbl->tm_yday = tm.tm_yday;
+	pbl->tm_isdst = tm.tm_isdst;
+}
+
+void string_format_time(char* ptr, size_t maxsize, const char* format, const PblTm* timeptr) {
+	struct tm tm;
+	to_tm(timeptr, &tm);
+	if (strftime(ptr, maxsize, format, &tm) == 0 && maxsize > 0) ptr[0] = '\0';
+}
+
+bool clock_is_24h_style(void) {
+	return false;
+}
+
+void vibes_short_pulse(void) {
+}
+
+// Dictionaries
+struct __attribute__((__packed__)) Dictionary {
+	uint8_t count;
+	Tuple head[];
+};
+
+#define TUPLE_HEADER_SIZE sizeof(Tuple)
+
+uint32_t dict_calc_buffer_size(const uint8_t tuple_count, ...) {
+	uint32_t size = sizeof(Dictionary);
+	va_list sizes;
+	va_start(sizes, tuple_count);
+	for (int i = 0; i < tuple_count; i++) {
+		size += TUPLE_HEADER_SIZE + va_arg(sizes, unsigned int);
+	}
+	va_end(sizes);
+	return size;
+}
+
+DictionaryResult dict_write_begin(DictionaryIterator* iter, uint8_t* const buffer, const uint16_t size) {
+	if (!iter || !buffer) return DICT_INVALID_ARGS;
+	if (size < sizeof(Dictionary)) return DICT_NOT_ENOUGH_STORAGE;
+	iter->dictionary = (Dictionary*)buffer;
+	iter->dictionary->count = 0;
+	iter->end = buffer + size;
+	iter->cursor = iter->dictionary->head;
+	return DICT_OK;
+}
+
+static DictionaryResult write_tuple(DictionaryIterator* iter, uint32_t key, TupleType type, const void* value, uint16_t length) {
+	if (!iter || !iter->cursor) return DICT_INVALID_ARGS;
+	if ((const uint8_t*)iter->cursor + TUPLE_HEADER_SIZE + length > (const uint8_t*)iter->end) {
+		return DICT_NOT_ENOUGH_STORAGE;
+	}
+	Tuple* tuple = iter->cursor;
+	tuple->key = key;
+	tuple->type = type;
+	tuple->length = length;
+	memcpy(tuple->value->data, value, length);
+	iter->cursor = (Tuple*)((uint8_t*)tuple + TUPLE_HEADER_SIZE + length);
+	iter->dictionary->count++;
+	return DICT_OK;
+}
+
+DictionaryResult dict_write_data(DictionaryIterator* iter, const uint32_t key, const uint8_t* const data, const uint16_t size) {
+	if (!data) return DICT_INVALID_ARGS;
+	return write_tuple(iter, key, TUPLE_BYTE_ARRAY, data, size);
+}
+
+DictionaryResult dict_write_cstring(DictionaryIterator* iter, const uint32_t key, const char* const cstring) {
+	if (!cstring) return write_tuple(iter, key, TUPLE_CSTRING, "", 0);
+	return write_tuple(iter, key, TUPLE_CSTRING, cstring, strlen(cstring) + 1);
+}
+
+DictionaryResult dict_write_int(DictionaryIterator* iter, const uint32_t key, const void* integer, const uint8_t width_bytes, const bool is_signed) {
+	if (!integer || (width_bytes != 1 && width_bytes != 2 && width_bytes != 4)) return DICT_INVALID_ARGS;
+	return write_tuple(iter, key, is_signed ? TUPLE_INT : TUPLE_UINT, integer, width_bytes);
+}
+
+DictionaryResult dict_write_uint8(DictionaryIterator* iter, const uint32_t key, const uint8_t value) {
+	return dict_write_int(iter, key, &value, sizeof(value), false);
+}
+
+DictionaryResult dict_write_uint16(DictionaryIterator* iter, const uint32_t key, const uint16_t value) {
+	return dict_write_int(iter, key, &value, sizeof(value), false);
+}
+
+DictionaryResult dict_write_uint32(DictionaryIterator* iter, const uint32_t key, const uint32_t value) {
+	return dict_write_int(iter, key, &value, sizeof(value), false);
+}
+
+DictionaryResult dict_write_int8(DictionaryIterator* iter, const uint32_t key, const int8_t value) {
+	return dict_write_int(iter, key, &value, sizeof(value), true);
+}
+
+DictionaryResult dict_write_int16(DictionaryIterator* iter, const uint32_t key, const int16_t value) {
+	return dict_write_int(iter, key, &value, sizeof(value), true);
+}
+
+DictionaryResult dict_write_int32(DictionaryIterator* iter, const uint32_t key, const int32_t value) {
+	return dict_write_int(iter, key, &value, sizeof(value), true);
+}
+
+uint32_t dict_write_end(DictionaryIterator* iter) {
+	if (!iter || !iter->cursor) return 0;
+	iter->end = iter->cursor;
+	return (uint8_t*)iter->cursor - (uint8_t*)iter->dictionary;
+}
+
+// Returns the tuple at the cursor and steps past it, or NULL at the end of
+// the buffer or on a tuple that runs past it.
+static Tuple* read_tuple(DictionaryIterator* iter) {
+	const uint8_t* at = (const uint8_t*)iter->cursor;
+	const uint8_t* end = (const uint8_t*)iter->end;
+	if (at + TUPLE_HEADER_SIZE > end) return NULL;
+	Tuple* tuple = iter->cursor;
+	if (at + TUPLE_HEADER_SIZE + tuple->length > end) return NULL;
+	iter->cursor = (Tuple*)(at + TUPLE_HEADER_SIZE + tuple->length);
+	return tuple;
+}
+
+Tuple* dict_read_begin_from_buffer(DictionaryIterator* iter, const uint8_t* const buffer, const uint16_t size) {
+	if (!iter || !buffer || size < sizeof(Dictionary)) return NULL;
+	iter->dictionary = (Dictionary*)buffer;
+	iter->end = buffer + size;
+	return dict_read_first(iter);
+}
+
+Tuple* dict_read_first(DictionaryIterator* iter) {
+	if (!iter || !iter->dictionary || iter->dictionary->count == 0) return NULL;
+	iter->cursor = iter->dictionary->head;
+	return read_tuple(iter);
+}
+
+Tuple* dict_read_next(DictionaryIterator* iter) {
+	return read_tuple(iter);
+}
+
+Tuple* dict_find(const DictionaryIterator* iter, const uint32_t key) {
+	DictionaryIterator walk = *iter;
+	for (Tuple* tuple = dict_read_first(&walk); tuple; tuple = dict_read_next(&walk)) {
+		if (tuple->key == key) return tuple;
+	}
+	return NULL;
+}
+
+// Events: timers, the ack for the message in flight and messages from the
+// phone, run in time order and in the order they were queued on a tie.
+typedef struct {
+	bool in_use;
+	uint64_t at;
+	uint32_t sequence;
+} HostEvent;
+
+static void event_schedule(HostEvent* event, uint32_t delay_ms) {
+	event->in_use = true;
+	event->at = now_ms + delay_ms;
+	event->sequence = event_sequence++;
+}
+
+static bool event_before(const HostEvent* a, const HostEvent* b) {
+	if (!b) return true;
+	return a->at < b->at || (a->at == b->at && a->sequence < b->sequence);
+}
+
+// Timers
+#define HOST_TIMER_CAPACITY 16
+
+typedef struct {
+	HostEvent event;
+	uint32_t cookie;
+} HostTimer;
+
+static HostTimer timers[HOST_TIMER_CAPACITY];
+
+AppTimerHandle app_timer_send_event(AppContextRef app_ctx, uint32_t timeout_ms, uint32_t cookie) {
+	for (int i = 0; i < HOST_TIMER_CAPACITY; i++) {
+		if (timers[i].event.in_use) continue;
+		event_schedule(&timers[i].event, timeout_ms);
+		timers[i].cookie = cookie;
+		return i + 1;
+	}
+	return 0;
+}
+
+bool app_timer_cancel_event(AppContextRef app_ctx_ref, AppTimerHandle handle) {
+	if (handle == 0 || handle > HOST_TIMER_CAPACITY || !timers[handle - 1].event.in_use) return false;
+	timers[handle - 1].event.in_use = false;
+	return true;
+}
+
+// AppMessage. One outbox, held from out_get until out_send or out_release
+// and busy until the send is acked.
+#define HOST_MESSAGE_MAX 256
+#define HOST_INBOX_CAPACITY 8
+
+typedef enum {
+	OUTBOX_FREE = 0,
+	OUTBOX_HELD,
+	OUTBOX_SENDING
+} OutboxState;
+
+typedef struct {
+	HostEvent event;
+	uint16_t size;
+	uint8_t data[HOST_MESSAGE_MAX];
+} HostMessage;
+
+static AppMessageCallbacksNode* callbacks_head;
+static OutboxState outbox_state;
+static uint8_t outbox[HOST_MESSAGE_MAX];
+static DictionaryIterator outbox_iter;
+static HostMessage in_flight;
+static HostMessage inbox[HOST_INBOX_CAPACITY];
+
+AppMessageResult app_message_register_callbacks(AppMessageCallbacksNode* callbacks_node) {
+	for (AppMessageCallbacksNode* node = callbacks_head; node; node = node->node) {
+		if (node == callbacks_node) return APP_MSG_CALLBACK_ALREADY_REGISTERED;
+	}
+	callbacks_node->node = callbacks_head;
+	callbacks_head = callbacks_node;
+	return APP_MSG_OK;
+}
+
+AppMessageResult app_message_deregister_callbacks(AppMessageCallbacksNode* callbacks_node) {
+	for (AppMessageCallbacksNode** link = &callbacks_head; *link; link = &(*link)->node) {
+		if (*link != callbacks_node) continue;
+		*link = callbacks_node->node;
+		callbacks_node->node = NULL;
+		return APP_MSG_OK;
+	}
+	return APP_MSG_CALLBACK_NOT_REGISTERED;
+}
+
+AppMessageResult app_message_out_get(DictionaryIterator** iter_out) {
+	if (outbox_state != OUTBOX_FREE) return APP_MSG_BUSY;
+	uint16_t size = app_handlers.messaging_info.buffer_sizes.outbound;
+	dict_write_begin(&outbox_iter, outbox, size < HOST_MESSAGE_MAX ? size : HOST_MESSAGE_MAX);
+	outbox_state = OUTBOX_HELD;
+	*iter_out = &outbox_iter;
+	return APP_MSG_OK;
+}
+
+AppMessageResult app_message_out_send(void) {
+	if (outbox_state != OUTBOX_HELD) return APP_MSG_INVALID_ARGS;
+	in_flight.size = dict_write_end(&outbox_iter);
+	memcpy(in_flight.data, outbox, in_flight.size);
+	event_schedule(&in_flight.event, host_bridge_connected() ? HOST_ACK_MS : HOST_SEND_TIMEOUT_MS);
+	outbox_state = OUTBOX_SENDING;
+	stats.messages_out++;
+	stats.bytes_out += in_flight.size;
+	return APP_MSG_OK;
+}
+
+AppMessageResult app_message_out_release(void) {
+	if (outbox_state != OUTBOX_HELD) return APP_MSG_ALREADY_RELEASED;
+	outbox_state = OUTBOX_FREE;
+	return APP_MSG_OK;
+}
+
+void host_inbox_push(const uint8_t* data, uint16_t size, uint32_t delay_ms) {
+	if (size > HOST_MESSAGE_MAX) size = HOST_MESSAGE_MAX;
+	for (int i = 0; i < HOST_INBOX_CAPACITY; i++) {
+		HostMessage* message = &inbox[i];
+		if (message->event.in_use) continue;
+		event_schedule(&message->event, delay_ms);
+		message->size = size;
+		memcpy(message->data, data, size);
+		return;
+	}
+	stats.inbound_dropped++;
+}
+
+// The phone sees the message when it acks it. Out of reach, the send times
+// out instead.
+static void deliver_ack() {
+	DictionaryIterator sent;
+	bool connected = host_bridge_connected();
+	in_flight.event.in_use = false;
+	outbox_state = OUTBOX_FREE;
+	dict_read_begin_from_buffer(&sent, in_flight.data, in_flight.size);
+	if (connected) {
+		host_bridge_receive(&sent);
+	}
+	else {
+		stats.send_failures++;
+	}
+	for (AppMessageCallbacksNode* node = callbacks_head; node; node = node->node) {
+		dict_read_begin_from_buffer(&sent, in_flight.data, in_flight.size);
+		if (connected && node->callbacks.out_sent) {
+			node->callbacks.out_sent(&sent, node->context);
+		}
+		else if (!connected && node->callbacks.out_failed) {
+			node->callbacks.out_failed(&sent, APP_MSG_SEND_TIMEOUT, node->context);
+		}
+	}
+}
+
+static void deliver_inbound(HostMessage* message) {
+	message->event.in_use = false;
+	bool fits = message->size <= app_handlers.messaging_info.buffer_sizes.inbound;
+	if (fits) {
+		stats.messages_in++;
+		stats.bytes_in += message->size;
+	}
+	else {
+		stats.inbound_dropped++;
+	}
+	for (AppMessageCallbacksNode* node = callbacks_head; node; node = node->node) {
+		if (!fits) {
+			if (node->callbacks.in_dropped) node->callbacks.in_dropped(node->context, APP_MSG_BUFFER_OVERFLOW);
+			continue;
+		}
+		DictionaryIterator received;
+		dict_read_begin_from_buffer(&received, message->data, message->size);
+		if (node->callbacks.in_received) node->callbacks.in_received(&received, node->context);
+	}
+}
+
+// Event loop
+void host_run_until(uint64_t ms) {
+	for (;;) {
+		HostEvent* next = NULL;
+		for (int i = 0; i < HOST_TIMER_CAPACITY; i++) {
+			if (timers[i].event.in_use && event_before(&timers[i].event, next)) next = &timers[i].event;
+		}
+		for (int i = 0; i < HOST_INBOX_CAPACITY; i++) {
+			if (inbox[i].event.in_use && event_before(&inbox[i].event, next)) next = &inbox[i].event;
+		}
+		if (in_flight.event.in_use && event_before(&in_flight.event, next)) next = &in_flight.event;
+		if (!next || next->at >= ms) break;
+
+		now_ms = next->at;
+		if (next == &in_flight.event) {
+			deliver_ack();
+		}
+		else if (next >= &inbox[0].event && next <= &inbox[HOST_INBOX_CAPACITY - 1].event) {
+			deliver_inbound((HostMessage*)next);
+		}
+		else {
+			HostTimer* timer = (HostTimer*)next;
+			timer->event.in_use = false;
+			stats.timers++;
+			if (app_handlers.timer_handler) {
+				app_handlers.timer_handler(&app_context, (AppTimerHandle)(timer - timers) + 1, timer->cookie);
+			}
+		}
+		render();
+	}
+	now_ms = ms;
+}
+
+void host_tick() {
+	PblTm tm;
+	get_time(&tm);
+	PebbleTickEvent event = {
+		.tick_time = &tm,
+		.units_changed = MINUTE_UNIT
+	};
+	if (tm.tm_min == 0) event.units_changed |= HOUR_UNIT;
+	if (tm.tm_min == 0 && tm.tm_hour == 0) event.units_changed |= DAY_UNIT;
+	if (app_handlers.tick_info.tick_handler) {
+		app_handlers.tick_info.tick_handler(&app_context, &event);
+	}
+	render();
+}
+
+void app_event_loop(AppTaskContextRef app_task_ctx, PebbleAppHandlers* handlers) {
+	app_handlers = *handlers;
+	if (app_handlers.init_handler) app_handlers.init_handler(&app_context);
+	render();
+	if (host_driver) host_driver(&app_handlers);
+	if (app_handlers.deinit_handler) app_handlers.deinit_handler(&app_context);
+}
+
+// Logging. long is 32 bits on the watch and the app's formats are written
+// for that, so length modifiers are dropped before the arguments are read.
+void app_log(uint8_t log_level, const char* src_filename, int src_line_number, const char* fmt, ...) {
+	char format[256];
+	size_t out = 0;
+	for (const char* in = fmt; *in && out < sizeof(format) - 1; in++) {
+		format[out++] = *in;
+		if (*in != '%') continue;
+		while (in[1] && strchr("-+ #0123456789.", in[1]) && out < sizeof(format) - 1) {
+			format[out++] = *++in;
+		}
+		while (in[1] == 'l' || in[1] == 'h' || in[1] == 'z') in++;
+	}
+	format[out] = '\0';
+
+	const char* file = strrchr(src_filename, '/');
+	uint32_t seconds = (uint32_t)(now_ms / 1000);
+	printf("%02u:%02u:%02u.%03u %s:%d ", seconds / 3600, seconds / 60 % 60, seconds % 60,
+		(uint32_t)(now_ms % 1000), file ? file + 1 : src_filename, src_line_number);
+	va_list args;
+	va_start(args, fmt);
+	vprintf(format, args);
+	va_end(args);
+	putchar('\n');
+}
@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Generates the resource ids for the host build from resource_map.json.
+
+Writes resource_ids.auto.h, numbered the way the SDK numbers them, and
+resources.auto.c, which maps each id to its file so pebble_shim.c can read
+bitmap sizes from the real images.
+
+Usage: resources.py resources/src/resource_map.json build_dir
+"""
+
+import json
+import os
+import sys
+
+
+def main():
+    resource_map, out_dir = sys.argv[1], sys.argv[2]
+    with open(resource_map) as f:
+        resources = json.load(f)
+    media = resources['media']
+    version = resources['versionDefName']
+
+    header = [
+        '// Generated by host/resources.py from resource_map.json',
+        '#ifndef RESOURCE_IDS_AUTO_H',
+        '#define RESOURCE_IDS_AUTO_H',
+        '',
+        'typedef enum {',
+        '\tINVALID_RESOURCE = 0,',
+    ]
+    for i, entry in enumerate(media):
+        header.append('\tRESOURCE_ID_%s = %d,' % (entry['defName'], i + 1))
+    header += [
+        '\tRESOURCE_COUNT',
+        '} ResourceId;',
+        '',
+        'extern const ResBankVersion %s;' % version,
+        '',
+        '// File of each resource, relative to resources/src',
+        'extern const char* const host_resource_files[RESOURCE_COUNT];',
+        '',
+        '#endif // RESOURCE_IDS_AUTO_H',
+    ]
+
+    source = [
+        '// Generated by host/resources.py from resource_map.json',
+        '#include "pebble_os.h"',
+        '#include "resource_ids.auto.h"',
+        '',
+        'const ResBankVersion %s = { 0, 0, "%s" };' % (version, resources['friendlyVersion']),
+        '',
+        'const char* const host_resource_files[RESOURCE_COUNT] = {',
+    ]
+    for entry in media:
+        source.append('\t[RESOURCE_ID_%s] = "%s",' % (entry['defName'], entry['file']))
+    source.append('};')
+
+    os.makedirs(out_dir, exist_ok=True)
+    with open(os.path.join(out_dir, 'resource_ids.auto.h'), 'w') as f:
+        f.write('\n'.join(header) + '\n')
+    with open(os.path.join(out_dir, 'resources.auto.c'), 'w') as f:
+        f.write('\n'.join(source) + '\n')
+
+
+if __name__ == '__main__':
+    main()
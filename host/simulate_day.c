@@ -0,0 +1,123 @@
+#include <stdio.h>
+
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "config.h"
+#include "perf.h"
+#include "weather_layer.h"
+#include "work_scheduler.h"
+#include "host.h"
+
+// Plays one day of minute ticks against the app and prints what each tick
+// cost, as a regression baseline: every counter in perf.h per tick (mean
+// and worst case) and for the day, plus the redraws and the AppMessage
+// traffic the shim saw and the redraws weather_layer_apply avoided. A tick's cost is everything that runs from that
+// tick up to the next one, so deferred work, acks and replies count against
+// the minute that caused them. The phone is out of reach from
+// OUTAGE_START to OUTAGE_END so the backoff and reconnect paths are part of
+// the baseline.
+
+#define DAY_TICKS 1440
+
+// The app's panel, defined in main.c
+extern WeatherLayer weather_layer;
+#define OUTAGE_START (13 * 60)
+#define OUTAGE_END (14 * 60)
+
+// Host-side totals reported next to the app's own counters
+#define HOST_COUNTERS(X) \
+	X(frames) \
+	X(layers_drawn) \
+	X(timers) \
+	X(messages_out) \
+	X(bytes_out) \
+	X(send_failures) \
+	X(messages_in) \
+	X(bytes_in) \
+	X(inbound_dropped)
+
+#define HOST_COUNTER_INDEX(name) HOST_##name,
+enum {
+	HOST_COUNTERS(HOST_COUNTER_INDEX)
+	HOST_COUNTER_COUNT
+};
+
+#define HOST_COUNTER_READ(name) values[HOST_##name] = stats->name;
+static void host_counters(uint32_t* values) {
+	const HostStats* stats = host_stats();
+	HOST_COUNTERS(HOST_COUNTER_READ)
+}
+
+#define HOST_COUNTER_NAME(name) #name,
+static const char* HOST_COUNTER_NAMES[HOST_COUNTER_COUNT] = {
+	HOST_COUNTERS(HOST_COUNTER_NAME)
+};
+
+static void print_row(const char* name, uint32_t total, uint32_t worst) {
+	// Per-tick mean in thousandths, like the watch logs
+	printf("day %-24s total=%-8u per_tick=%u.%03u max=%u\n", name, total,
+		total / DAY_TICKS, (uint32_t)((uint64_t)total * 1000 / DAY_TICKS % 1000), worst);
+}
+
+static void simulate_day(const PebbleAppHandlers* handlers) {
+	uint32_t start[PERF_COUNTER_COUNT], before[PERF_COUNTER_COUNT], worst[PERF_COUNTER_COUNT];
+	uint32_t host_start[HOST_COUNTER_COUNT], host_before[HOST_COUNTER_COUNT], host_worst[HOST_COUNTER_COUNT];
+	uint32_t host_now_values[HOST_COUNTER_COUNT];
+	uint32_t avoided_start, avoided_worst = 0;
+
+	// Startup traffic settles within the first minute and is not part of
+	// the day
+	host_run_until(HOST_MS_PER_MINUTE);
+	memcpy(start, perf_counters, sizeof(start));
+	host_counters(host_start);
+	avoided_start = weather_layer.redraws_avoided;
+	memset(worst, 0, sizeof(worst));
+	memset(host_worst, 0, sizeof(host_worst));
+
+	for (int minute = 1; minute <= DAY_TICKS; minute++) {
+		if (minute == OUTAGE_START) host_bridge_set_connected(false);
+		if (minute == OUTAGE_END) host_bridge_set_connected(true);
+
+		memcpy(before, perf_counters, sizeof(before));
+		host_counters(host_before);
+		uint32_t avoided_before = weather_layer.redraws_avoided;
+		host_tick();
+		host_run_until((uint64_t)(minute + 1) * HOST_MS_PER_MINUTE);
+
+		for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+			uint32_t delta = perf_counters[i] - before[i];
+			if (delta > worst[i]) worst[i] = delta;
+		}
+		host_counters(host_now_values);
+		for (int i = 0; i < HOST_COUNTER_COUNT; i++) {
+			uint32_t delta = host_now_values[i] - host_before[i];
+			if (delta > host_worst[i]) host_worst[i] = delta;
+		}
+		uint32_t avoided = weather_layer.redraws_avoided - avoided_before;
+		if (avoided > avoided_worst) avoided_worst = avoided;
+	}
+
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		print_row(perf_counter_name(i), perf_counters[i] - start[i], worst[i]);
+	}
+	host_counters(host_now_values);
+	for (int i = 0; i < HOST_COUNTER_COUNT; i++) {
+		print_row(HOST_COUNTER_NAMES[i], host_now_values[i] - host_start[i], host_worst[i]);
+	}
+	print_row("redraws_avoided", weather_layer.redraws_avoided - avoided_start, avoided_worst);
+
+	const BridgeStats* bridge = host_bridge_stats();
+	printf("day bridge data=%u not_modified=%u location=%u cookie=%u time=%u other=%u\n",
+		bridge->data_requests, bridge->not_modified, bridge->location_requests,
+		bridge->cookie_requests, bridge->time_requests, bridge->other);
+
+	const WorkStats* work = work_scheduler_stats();
+	printf("day work deferred=%u ran=%u coalesced=%u overflowed=%u max_depth=%u\n",
+		work->deferred, work->ran, work->coalesced, work->overflowed, work->max_depth);
+}
+
+int main(void) {
+	host_driver = simulate_day;
+	pbl_main(NULL);
+	return 0;
+}
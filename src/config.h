@@ -1,4 +1,41 @@
 // Any of "us", "ca", "uk" (for idiosyncratic US, Candian and British measurements),
 // "si" (for pure metric) or "auto" (determined by the above latitude/longitude)
 #define UNIT_SYSTEM "auto"
-//#define DEBUG
\ No newline at end of file
+//#define DEBUG
+
+// Polling policy: minutes between requests while the link is healthy, and the
+// ceiling the failure backoff doubles up to while the phone is unreachable.
+#define POLL_INTERVAL_MINUTES 1
+#define POLL_BACKOFF_MAX_MINUTES 30
+
+// Count SDK hot-path calls (see perf.h). For a per-tick cost baseline over
+// a simulated day, run the host build: make -C host run
+//#define PERF_COUNTERS
+// Replay recorded inbound bridge messages through the dispatcher at startup
+// and log per-type decode cost (needs PERF_COUNTERS).
+//#define PERF_REPLAY
+// Time every layer draw and log p50/p99 cycles per layer and frames per
+// minute each minute when DEBUG is on (needs PERF_COUNTERS).
+//#define PROFILE_RENDER
+// Log struct sizes, resident bitmaps with their heap bytes, and layer pool use
+// at startup and every hour (needs PERF_COUNTERS).
+//#define MEMORY_REPORT
+
+// Location refresh: the interval stretches toward the maximum while the watch
+// stays put and drops to the minimum once it moves more than the threshold
+// (plus the reported fix accuracy).
+#define LOCATION_INTERVAL_MIN_MINUTES 5
+#define LOCATION_INTERVAL_DEFAULT_MINUTES 15
+#define LOCATION_INTERVAL_MAX_MINUTES 120
+#define LOCATION_MOVE_THRESHOLD_METERS 250
+
+// Energy budget (see energy_budget.h). Costs are relative to one AppMessage
+// send. The refill covers a poll every minute plus a location fix every
+// 15 minutes; anything beyond that draws the bucket down and stretches the
+// poll and location intervals.
+#define ENERGY_COST_MESSAGE_SEND 10
+#define ENERGY_COST_LOCATION_REQUEST 40
+#define ENERGY_COST_VIBRATION 25
+#define ENERGY_COST_PANEL_REDRAW 2
+#define ENERGY_BUDGET_CAPACITY 600
+#define ENERGY_REFILL_PER_MINUTE 15
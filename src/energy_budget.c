@@ -0,0 +1,65 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "config.h"
+#include "energy_budget.h"
+
+#define MINUTES_PER_DAY 1440
+
+static const uint16_t ENERGY_COSTS[ENERGY_ACTION_COUNT] = {
+	[ENERGY_MESSAGE_SEND] = ENERGY_COST_MESSAGE_SEND,
+	[ENERGY_LOCATION_REQUEST] = ENERGY_COST_LOCATION_REQUEST,
+	[ENERGY_VIBRATION] = ENERGY_COST_VIBRATION,
+	[ENERGY_PANEL_REDRAW] = ENERGY_COST_PANEL_REDRAW,
+};
+
+static const char* ENERGY_ACTION_NAMES[ENERGY_ACTION_COUNT] = {
+	"message_send",
+	"location_request",
+	"vibration",
+	"panel_redraw",
+};
+
+void energy_budget_init(EnergyBudget* budget) {
+	memset(budget, 0, sizeof(EnergyBudget));
+	budget->level = ENERGY_BUDGET_CAPACITY;
+}
+
+void energy_budget_spend(EnergyBudget* budget, EnergyAction action) {
+	budget->level -= ENERGY_COSTS[action];
+	budget->spent += ENERGY_COSTS[action];
+	budget->counts[action]++;
+}
+
+static int stretch_index(const EnergyBudget* budget) {
+	if (budget->level * 2 >= ENERGY_BUDGET_CAPACITY) return 0;
+	if (budget->level * 4 >= ENERGY_BUDGET_CAPACITY) return 1;
+	return 2;
+}
+
+void energy_budget_minute(EnergyBudget* budget) {
+	budget->minutes_at[stretch_index(budget)]++;
+	budget->minutes++;
+	budget->level += ENERGY_REFILL_PER_MINUTE;
+	if (budget->level > ENERGY_BUDGET_CAPACITY) budget->level = ENERGY_BUDGET_CAPACITY;
+}
+
+uint8_t energy_budget_stretch(const EnergyBudget* budget) {
+	return 1 << stretch_index(budget);
+}
+
+uint32_t energy_budget_projected_daily(const EnergyBudget* budget) {
+	if (budget->minutes == 0) return 0;
+	return (uint64_t)budget->spent * MINUTES_PER_DAY / budget->minutes;
+}
+
+void energy_budget_log(const EnergyBudget* budget, const char* label) {
+	for (int i = 0; i < ENERGY_ACTION_COUNT; i++) {
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "energy %s %s count=%lu spent=%lu", label, ENERGY_ACTION_NAMES[i],
+			budget->counts[i], budget->counts[i] * ENERGY_COSTS[i]);
+	}
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "energy %s level=%ld/%d minutes=%lu at_x1=%lu at_x2=%lu at_x4=%lu",
+		label, budget->level, ENERGY_BUDGET_CAPACITY, budget->minutes,
+		budget->minutes_at[0], budget->minutes_at[1], budget->minutes_at[2]);
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "energy %s projected_daily=%lu refill_daily=%lu", label,
+		energy_budget_projected_daily(budget), (uint32_t)ENERGY_REFILL_PER_MINUTE * MINUTES_PER_DAY);
+}
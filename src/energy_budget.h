@@ -0,0 +1,50 @@
+#ifndef ENERGY_BUDGET_H
+#define ENERGY_BUDGET_H
+
+// Modelled battery cost of what the face does beyond telling the time. Each
+// action is charged against a bucket that refills a little every minute;
+// as the bucket drains, the poll and location intervals are stretched so
+// the average spend falls back toward the refill rate. Costs and rates are
+// in config.h, in arbitrary units relative to one AppMessage send.
+
+typedef enum {
+	ENERGY_MESSAGE_SEND = 0,
+	ENERGY_LOCATION_REQUEST,
+	ENERGY_VIBRATION,
+	ENERGY_PANEL_REDRAW,
+	ENERGY_ACTION_COUNT
+} EnergyAction;
+
+// Stretch factors x1, x2 and x4
+#define ENERGY_STRETCH_LEVELS 3
+
+typedef struct {
+	int32_t level;
+	uint32_t minutes;
+	uint32_t spent;
+	uint32_t counts[ENERGY_ACTION_COUNT];
+	// Minutes spent at each stretch level, healthy first
+	uint32_t minutes_at[ENERGY_STRETCH_LEVELS];
+} EnergyBudget;
+
+// Starts with a full bucket
+void energy_budget_init(EnergyBudget* budget);
+
+// Charges an action. The level may go negative: the action has already
+// happened, and the debt is paid back out of later refills.
+void energy_budget_spend(EnergyBudget* budget, EnergyAction action);
+
+// Call once a minute to refill the bucket
+void energy_budget_minute(EnergyBudget* budget);
+
+// Factor to multiply poll and location intervals by: 1 while at least half
+// the bucket is left, 2 down to a quarter, 4 below that.
+uint8_t energy_budget_stretch(const EnergyBudget* budget);
+
+// Spend per day at the rate seen so far, to compare with the daily refill
+uint32_t energy_budget_projected_daily(const EnergyBudget* budget);
+
+// Logs the level, the spend per action and the projection
+void energy_budget_log(const EnergyBudget* budget, const char* label);
+
+#endif // ENERGY_BUDGET_H
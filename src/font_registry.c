@@ -0,0 +1,43 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "pebble_fonts.h"
+#include "font_registry.h"
+#include "config.h"
+#include "perf.h"
+
+static const uint32_t FONT_RESOURCES[FONT_SLOT_COUNT] = {
+	RESOURCE_ID_FUTURA_18,
+	RESOURCE_ID_FUTURA_35,
+	RESOURCE_ID_FUTURA_40,
+	RESOURCE_ID_FUTURA_CONDENSED_53,
+};
+
+static GFont fonts[FONT_SLOT_COUNT];
+static uint8_t refcounts[FONT_SLOT_COUNT];
+static uint16_t load_count = 0, unload_count = 0;
+
+GFont font_registry_acquire(FontSlot slot) {
+	if (refcounts[slot] == 0) {
+		fonts[slot] = fonts_load_custom_font(resource_get_handle(FONT_RESOURCES[slot]));
+		load_count++;
+	}
+	refcounts[slot]++;
+	return fonts[slot];
+}
+
+void font_registry_release(FontSlot slot) {
+	if (refcounts[slot] == 0) return;
+	if (--refcounts[slot] == 0) {
+		fonts_unload_custom_font(fonts[slot]);
+		fonts[slot] = NULL;
+		unload_count++;
+	}
+}
+
+uint16_t font_registry_load_count() {
+	return load_count;
+}
+
+uint16_t font_registry_unload_count() {
+	return unload_count;
+}
@@ -0,0 +1,22 @@
+#ifndef FONT_REGISTRY_H
+#define FONT_REGISTRY_H
+
+typedef enum {
+	FONT_FUTURA_18 = 0,
+	FONT_FUTURA_35,
+	FONT_FUTURA_40,
+	FONT_FUTURA_CONDENSED_53,
+	FONT_SLOT_COUNT
+} FontSlot;
+
+// Shared custom font handles. Each slot is loaded on its first acquire and
+// unloaded when the last holder releases it.
+GFont font_registry_acquire(FontSlot slot);
+void font_registry_release(FontSlot slot);
+
+// Number of fonts_load_custom_font calls made so far. Should stay flat after
+// startup; memory_report logs both counts.
+uint16_t font_registry_load_count();
+uint16_t font_registry_unload_count();
+
+#endif // FONT_REGISTRY_H
@@ -1,33 +1,86 @@
 #include "pebble_os.h"
+#include "pebble_app.h"
 #include "http.h"
-
-#define HTTP_URL_KEY 0xFFFF
-#define HTTP_STATUS_KEY 0xFFFE
-#define HTTP_COOKIE_KEY 0xFFFC
-#define HTTP_CONNECT_KEY 0xFFFB
-#define HTTP_USE_GET_KEY 0xFFFA
-	
-#define HTTP_APP_ID_KEY 0xFFF2
-#define HTTP_COOKIE_STORE_KEY 0xFFF0
-#define HTTP_COOKIE_LOAD_KEY 0xFFF1
-#define HTTP_COOKIE_FSYNC_KEY 0xFFF3
-#define HTTP_COOKIE_DELETE_KEY 0xFFF4
-	
-#define HTTP_TIME_KEY 0xFFF5
-#define HTTP_UTC_OFFSET_KEY 0xFFF6
-#define HTTP_IS_DST_KEY 0xFFF7
-#define HTTP_TZ_NAME_KEY 0xFFF8
-
-#define HTTP_LOCATION_KEY 0xFFE0
-#define HTTP_LATITUDE_KEY 0xFFE1
-#define HTTP_LONGITUDE_KEY 0xFFE2
-#define HTTP_ALTITUDE_KEY 0xFFE3
+#include "http_keys.h"
+#include "work_scheduler.h"
+#include "config.h"
+#include "perf.h"
+
+// Inbound reserved keys, sorted into a fixed table in one pass over the
+// dictionary so dispatch and the handlers never have to dict_find.
+typedef enum {
+	HTTP_SLOT_URL = 0,
+	HTTP_SLOT_STATUS,
+	HTTP_SLOT_COOKIE,
+	HTTP_SLOT_CONNECT,
+	HTTP_SLOT_APP_ID,
+	HTTP_SLOT_COOKIE_STORE,
+	HTTP_SLOT_COOKIE_LOAD,
+	HTTP_SLOT_COOKIE_FSYNC,
+	HTTP_SLOT_COOKIE_DELETE,
+	HTTP_SLOT_TIME,
+	HTTP_SLOT_UTC_OFFSET,
+	HTTP_SLOT_IS_DST,
+	HTTP_SLOT_TZ_NAME,
+	HTTP_SLOT_LOCATION,
+	HTTP_SLOT_LATITUDE,
+	HTTP_SLOT_LONGITUDE,
+	HTTP_SLOT_ALTITUDE,
+	// Application key the bridge echoes the request nonce back under
+	HTTP_SLOT_NONCE,
+	HTTP_SLOT_COUNT
+} HTTPKeySlot;
+
+// Outbound requests waiting for the single AppMessage outbox.
+typedef enum {
+	HTTP_QUEUE_GET = 0,
+	HTTP_QUEUE_LOCATION,
+	HTTP_QUEUE_TIME,
+	HTTP_QUEUE_COOKIE_GET,
+	HTTP_QUEUE_COOKIE_SET,
+	HTTP_QUEUE_COOKIE_DELETE,
+	HTTP_QUEUE_COOKIE_FSYNC
+} HTTPQueueKind;
+
+typedef struct {
+	HTTPQueueKind kind;
+	int32_t request_id;
+	// HTTP_QUEUE_GET
+	const char* url;
+	HTTPRequestBodyBuilder builder;
+	void* builder_context;
+	// Cookie operations
+	uint32_t key;
+	TupleType value_type;
+	uint8_t value_length;
+	uint8_t value[HTTP_QUEUE_VALUE_MAX];
+} HTTPQueueEntry;
+
+static HTTPQueueEntry queue[HTTP_QUEUE_CAPACITY];
+static HTTPQueueStats queue_stats;
+static bool out_in_flight;
+
+// GETs that have been sent and are waiting for their response.
+typedef struct {
+	bool in_use;
+	int32_t request_id;
+	int32_t nonce;
+	uint16_t sequence;
+	time_t sent_at;
+	time_t deadline;
+} HTTPPendingRequest;
+
+static HTTPPendingRequest pending[HTTP_PENDING_CAPACITY];
+static uint16_t pending_sequence;
+static uint32_t nonce_send_key, nonce_echo_key;
+static uint16_t late_responses;
 
 static bool callbacks_registered;
 static AppMessageCallbacksNode app_callbacks;
 static HTTPCallbacks http_callbacks;
 static int32_t our_app_id;
 
+static void app_sent(DictionaryIterator* sent, void* context);
 static void app_send_failed(DictionaryIterator* failed, AppMessageResult reason, void* context);
 static void app_received(DictionaryIterator* received, void* context);
 static void app_dropped(void* context, AppMessageResult reason);
@@ -53,12 +106,21 @@ HTTPResult http_out_get(const char* url, int32_t cookie, DictionaryIterator **it
 }
 
 
-HTTPResult http_out_send() {
+// Sends whatever is in the outbox and marks it busy until the bridge acks.
+static AppMessageResult out_send() {
 	AppMessageResult result = app_message_out_send();
 	app_message_out_release(); // We don't care if it's already released.
+	if(result == APP_MSG_OK) {
+		out_in_flight = true;
+		queue_stats.sent++;
+	}
 	return result;
 }
 
+HTTPResult http_out_send() {
+	return out_send();
+}
+
 bool http_register_callbacks(HTTPCallbacks callbacks, void* context) {
 	http_callbacks = callbacks;
 	if(callbacks_registered) {
@@ -68,6 +130,7 @@ bool http_register_callbacks(HTTPCallbacks callbacks, void* context) {
 	if(!callbacks_registered) {
 		app_callbacks = (AppMessageCallbacksNode){
 			.callbacks = {
+				.out_sent = app_sent,
 				.out_failed = app_send_failed,
 				.in_received = app_received,
 				.in_dropped = app_dropped,
@@ -80,14 +143,142 @@ bool http_register_callbacks(HTTPCallbacks callbacks, void* context) {
 	return callbacks_registered;
 }
 
+static void queue_pump();
+
+// Pending request table
+void http_set_nonce_keys(uint32_t send_key, uint32_t echo_key) {
+	nonce_send_key = send_key;
+	nonce_echo_key = echo_key;
+}
+
+// The bridge may echo the nonce at a narrower width than it was sent.
+static int32_t tuple_int_value(Tuple* tuple) {
+	switch(tuple->length) {
+	case 1: return tuple->value->int8;
+	case 2: return tuple->value->int16;
+	default: return tuple->value->int32;
+	}
+}
+
+static HTTPPendingRequest* pending_find(int32_t request_id, Tuple* nonce_tuple) {
+	HTTPPendingRequest* found = NULL;
+	for(int i = 0; i < HTTP_PENDING_CAPACITY; ++i) {
+		HTTPPendingRequest* entry = &pending[i];
+		if(!entry->in_use || entry->request_id != request_id) continue;
+		if(nonce_tuple) {
+			if(entry->nonce == tuple_int_value(nonce_tuple)) return entry;
+		}
+		// Without a nonce, the oldest request with this id is the best guess.
+		else if(!found || entry->sequence < found->sequence) {
+			found = entry;
+		}
+	}
+	return found;
+}
+
+static int32_t pending_new_nonce() {
+	for(;;) {
+		int32_t nonce = rand() % 2000;
+		bool taken = false;
+		for(int i = 0; i < HTTP_PENDING_CAPACITY; ++i) {
+			if(pending[i].in_use && pending[i].nonce == nonce) taken = true;
+		}
+		if(!taken) return nonce;
+	}
+}
+
+static void pending_fail(HTTPPendingRequest* entry, int http_status) {
+	entry->in_use = false;
+	if(http_callbacks.failure) {
+		http_callbacks.failure(entry->request_id, http_status, app_callbacks.context);
+	}
+}
+
+static HTTPPendingRequest* pending_add(int32_t request_id, int32_t nonce) {
+	HTTPPendingRequest* slot = NULL;
+	for(int i = 0; i < HTTP_PENDING_CAPACITY; ++i) {
+		HTTPPendingRequest* entry = &pending[i];
+		if(!entry->in_use) {
+			slot = entry;
+			break;
+		}
+		if(!slot || entry->sequence < slot->sequence) slot = entry;
+	}
+	// Table full: give up on the oldest request to make room.
+	if(slot->in_use) {
+		pending_fail(slot, 1000 + HTTP_REQUEST_TIMEOUT);
+	}
+	time_t now = time(NULL);
+	*slot = (HTTPPendingRequest){
+		.in_use = true,
+		.request_id = request_id,
+		.nonce = nonce,
+		.sequence = ++pending_sequence,
+		.sent_at = now,
+		.deadline = now + HTTP_REQUEST_TIMEOUT_SECONDS
+	};
+	return slot;
+}
+
+// Once a response has been delivered, older requests with the same id can
+// only carry staler data, so they are retired without a callback.
+static void pending_retire_older(HTTPPendingRequest* delivered) {
+	for(int i = 0; i < HTTP_PENDING_CAPACITY; ++i) {
+		HTTPPendingRequest* entry = &pending[i];
+		if(entry->in_use && entry->request_id == delivered->request_id &&
+		   entry->sequence < delivered->sequence) {
+			entry->in_use = false;
+		}
+	}
+	delivered->in_use = false;
+}
+
+void http_check_timeouts() {
+	time_t now = time(NULL);
+	for(int i = 0; i < HTTP_PENDING_CAPACITY; ++i) {
+		if(pending[i].in_use && now >= pending[i].deadline) {
+			pending_fail(&pending[i], 1000 + HTTP_REQUEST_TIMEOUT);
+		}
+	}
+}
+
+uint8_t http_pending_count() {
+	uint8_t count = 0;
+	for(int i = 0; i < HTTP_PENDING_CAPACITY; ++i) {
+		if(pending[i].in_use) count++;
+	}
+	return count;
+}
+
+uint16_t http_late_response_count() {
+	return late_responses;
+}
+
+static void app_sent(DictionaryIterator* sent, void* context) {
+	out_in_flight = false;
+	queue_pump();
+}
+
 static void app_send_failed(DictionaryIterator* failed, AppMessageResult reason, void* context) {
-	if(!http_callbacks.failure) return;
-	http_callbacks.failure(0, 1000 + reason, context);
+	out_in_flight = false;
+	// Match a failed GET to its pending entry so the right request fails.
+	Tuple* cookie_tuple = failed ? dict_find(failed, HTTP_COOKIE_KEY) : NULL;
+	HTTPPendingRequest* entry = NULL;
+	if(cookie_tuple) {
+		entry = pending_find(cookie_tuple->value->int32, nonce_send_key ? dict_find(failed, nonce_send_key) : NULL);
+	}
+	if(entry) {
+		pending_fail(entry, 1000 + reason);
+	}
+	else if(http_callbacks.failure) {
+		http_callbacks.failure(cookie_tuple ? cookie_tuple->value->int32 : 0, 1000 + reason, context);
+	}
+	queue_pump();
 }
 
-static void app_received_http_response(DictionaryIterator* received, bool success, void* context) {
-	Tuple* status_tuple = dict_find(received, HTTP_STATUS_KEY);
-	Tuple* cookie_tuple = dict_find(received, HTTP_COOKIE_KEY);
+static void app_received_http_response(DictionaryIterator* received, Tuple** slots, bool success, void* context) {
+	Tuple* status_tuple = slots[HTTP_SLOT_STATUS];
+	Tuple* cookie_tuple = slots[HTTP_SLOT_COOKIE];
 	if(status_tuple == NULL || cookie_tuple == NULL) {
 		if(http_callbacks.failure) {
 			http_callbacks.failure(0, 1000 + HTTP_INVALID_BRIDGE_RESPONSE, context);
@@ -96,6 +287,16 @@ static void app_received_http_response(DictionaryIterator* received, bool succes
 	}
 	uint16_t status = status_tuple->value->int16;
 	int32_t cookie = cookie_tuple->value->int32;
+	HTTPPendingRequest* entry = pending_find(cookie, slots[HTTP_SLOT_NONCE]);
+	if(entry) {
+		pending_retire_older(entry);
+	}
+	else if(nonce_echo_key) {
+		// Timed out, superseded by a newer response already delivered, or
+		// missing the nonce that every answer to our GETs carries.
+		late_responses++;
+		return;
+	}
 	if(!success) {
 		if(http_callbacks.failure) {
 			http_callbacks.failure(cookie, status, context);
@@ -139,21 +340,13 @@ static void app_received_cookie_delete_response(int32_t request_id, void* contex
 	}
 }
 
-static void app_received_time(uint32_t unixtime, DictionaryIterator *iter, void* context) {
+static void app_received_time(uint32_t unixtime, Tuple** slots, void* context) {
 	if(!http_callbacks.time) return;
-	int32_t utc_offset;
-	bool is_dst;
-	const char* tz_name;
-	Tuple* tuple = dict_find(iter, HTTP_UTC_OFFSET_KEY);
-	if(!tuple) return;
-	utc_offset = tuple->value->int32;
-	tuple = dict_find(iter, HTTP_IS_DST_KEY);
-	if(!tuple) return;
-	is_dst = tuple->value->uint8;
-	tuple = dict_find(iter, HTTP_TZ_NAME_KEY);
-	if(!tuple) return;
-	tz_name = tuple->value->cstring;
-	http_callbacks.time(utc_offset, is_dst, unixtime, tz_name, context);
+	Tuple* utc_offset = slots[HTTP_SLOT_UTC_OFFSET];
+	Tuple* is_dst = slots[HTTP_SLOT_IS_DST];
+	Tuple* tz_name = slots[HTTP_SLOT_TZ_NAME];
+	if(!utc_offset || !is_dst || !tz_name) return;
+	http_callbacks.time(utc_offset->value->int32, is_dst->value->uint8, unixtime, tz_name->value->cstring, context);
 }
 
 // Handy helper for getting floats out of ints.
@@ -165,36 +358,69 @@ float floatFromUint32(uint32_t value) {
 	return ((struct alias_float*)&value)->f;
 }
 
-static void app_received_location(uint32_t accuracy_int, DictionaryIterator *iter, void* context) {
+static void app_received_location(uint32_t accuracy_int, Tuple** slots, void* context) {
 	if(!http_callbacks.location) return;
 	float accuracy = floatFromUint32(accuracy_int);
 	float latitude = 0.f;
 	float longitude = 0.f;
 	float altitude = 0.f;	
 
-	Tuple* tuple = dict_read_first(iter);
-	if(!tuple) return;
-	do {
-		switch(tuple->key) {
-		case HTTP_LATITUDE_KEY:
-			latitude = floatFromUint32(tuple->value->uint32);
-			break;
-		case HTTP_LONGITUDE_KEY:
-			longitude = floatFromUint32(tuple->value->uint32);
-			break;
-		case HTTP_ALTITUDE_KEY:
-			altitude = floatFromUint32(tuple->value->uint32);
-			break;
-		default:
-			break;
-		}
-	} while((tuple = dict_read_next(iter)));
+	if(slots[HTTP_SLOT_LATITUDE]) {
+		latitude = floatFromUint32(slots[HTTP_SLOT_LATITUDE]->value->uint32);
+	}
+	if(slots[HTTP_SLOT_LONGITUDE]) {
+		longitude = floatFromUint32(slots[HTTP_SLOT_LONGITUDE]->value->uint32);
+	}
+	if(slots[HTTP_SLOT_ALTITUDE]) {
+		altitude = floatFromUint32(slots[HTTP_SLOT_ALTITUDE]->value->uint32);
+	}
 	http_callbacks.location(latitude, longitude, altitude, accuracy, context);	
 }
 
+static HTTPKeySlot slot_for_key(uint32_t key) {
+	switch(key) {
+	case HTTP_URL_KEY: return HTTP_SLOT_URL;
+	case HTTP_STATUS_KEY: return HTTP_SLOT_STATUS;
+	case HTTP_COOKIE_KEY: return HTTP_SLOT_COOKIE;
+	case HTTP_CONNECT_KEY: return HTTP_SLOT_CONNECT;
+	case HTTP_APP_ID_KEY: return HTTP_SLOT_APP_ID;
+	case HTTP_COOKIE_STORE_KEY: return HTTP_SLOT_COOKIE_STORE;
+	case HTTP_COOKIE_LOAD_KEY: return HTTP_SLOT_COOKIE_LOAD;
+	case HTTP_COOKIE_FSYNC_KEY: return HTTP_SLOT_COOKIE_FSYNC;
+	case HTTP_COOKIE_DELETE_KEY: return HTTP_SLOT_COOKIE_DELETE;
+	case HTTP_TIME_KEY: return HTTP_SLOT_TIME;
+	case HTTP_UTC_OFFSET_KEY: return HTTP_SLOT_UTC_OFFSET;
+	case HTTP_IS_DST_KEY: return HTTP_SLOT_IS_DST;
+	case HTTP_TZ_NAME_KEY: return HTTP_SLOT_TZ_NAME;
+	case HTTP_LOCATION_KEY: return HTTP_SLOT_LOCATION;
+	case HTTP_LATITUDE_KEY: return HTTP_SLOT_LATITUDE;
+	case HTTP_LONGITUDE_KEY: return HTTP_SLOT_LONGITUDE;
+	case HTTP_ALTITUDE_KEY: return HTTP_SLOT_ALTITUDE;
+	default: return HTTP_SLOT_COUNT;
+	}
+}
+
 static void app_received(DictionaryIterator* received, void* context) {
+	Tuple* slots[HTTP_SLOT_COUNT];
+	memset(slots, 0, sizeof(slots));
+
+	// One walk over the message. Application keys are skipped cheaply since
+	// every reserved key sits at 0xFFE0 or above.
+	for(Tuple* tuple = dict_read_first(received); tuple; tuple = dict_read_next(received)) {
+		if(tuple->key < HTTP_LOCATION_KEY) {
+			if(nonce_echo_key && tuple->key == nonce_echo_key && !slots[HTTP_SLOT_NONCE]) {
+				slots[HTTP_SLOT_NONCE] = tuple;
+			}
+			continue;
+		}
+		HTTPKeySlot slot = slot_for_key(tuple->key);
+		if(slot != HTTP_SLOT_COUNT && !slots[slot]) {
+			slots[slot] = tuple;
+		}
+	}
+
 	// Reconnect message (special: no app id)
-	Tuple* tuple = dict_find(received, HTTP_CONNECT_KEY);
+	Tuple* tuple = slots[HTTP_SLOT_CONNECT];
 	if(tuple && tuple->value->uint8) {
 		if(http_callbacks.reconnect) {
 			http_callbacks.reconnect(context);
@@ -202,19 +428,19 @@ static void app_received(DictionaryIterator* received, void* context) {
 		return;
 	}
 	// Time response (special: no app id)
-	tuple = dict_find(received, HTTP_TIME_KEY);
+	tuple = slots[HTTP_SLOT_TIME];
 	if(tuple) {
-		app_received_time(tuple->value->uint32, received, context);
+		app_received_time(tuple->value->uint32, slots, context);
 		return;
 	}
 	// Location response (special: no app id)
-	tuple = dict_find(received, HTTP_LOCATION_KEY);
+	tuple = slots[HTTP_SLOT_LOCATION];
 	if(tuple) {
-		app_received_location(tuple->value->uint32, received, context);
+		app_received_location(tuple->value->uint32, slots, context);
 		return;
 	}
 	// Check for the app id
-	tuple = dict_find(received, HTTP_APP_ID_KEY);
+	tuple = slots[HTTP_SLOT_APP_ID];
 	if(!tuple) {
 		return;
 	}
@@ -222,76 +448,209 @@ static void app_received(DictionaryIterator* received, void* context) {
 	if(tuple->value->int32 != our_app_id) return;
 
 	// HTTP responses
-	tuple = dict_find(received, HTTP_URL_KEY);
+	tuple = slots[HTTP_SLOT_URL];
 	if(tuple) {
-		app_received_http_response(received, tuple->value->uint8, context);
+		app_received_http_response(received, slots, tuple->value->uint8, context);
 		return;
 	}
 
 	// Cookie set confirmation
-	tuple = dict_find(received, HTTP_COOKIE_STORE_KEY);
+	tuple = slots[HTTP_SLOT_COOKIE_STORE];
 	if(tuple) {
 		app_received_cookie_set_response(tuple->value->int32, context);
 		return;
 	}
 
 	// Cookie get response
-	tuple = dict_find(received, HTTP_COOKIE_LOAD_KEY);
+	tuple = slots[HTTP_SLOT_COOKIE_LOAD];
 	if(tuple) {
 		app_received_cookie_get_response(tuple->value->int32, received, context);
 		return;
 	}
 
 	// Save response
-	tuple = dict_find(received, HTTP_COOKIE_FSYNC_KEY);
+	tuple = slots[HTTP_SLOT_COOKIE_FSYNC];
 	if(tuple) {
 		app_received_cookie_fsync_response(tuple->value->uint8, context);
 		return;
 	}
 	
 	// Delete response
-	tuple = dict_find(received, HTTP_COOKIE_DELETE_KEY);
+	tuple = slots[HTTP_SLOT_COOKIE_DELETE];
 	if(tuple) {
 		app_received_cookie_delete_response(tuple->value->int32, context);
 		return;
 	}
 }
 
+#ifdef PERF_REPLAY
+void http_replay_received(DictionaryIterator* received, void* context) {
+	app_received(received, context);
+}
+#endif
+
 static void app_dropped(void* context, AppMessageResult reason) {
 	if(!http_callbacks.failure) return;
 	http_callbacks.failure(0, 1000 + reason, context);
 }
 
-// Time stuff
-HTTPResult http_time_request() {
+// Outbound queue
+static HTTPResult queue_send(HTTPQueueEntry* entry) {
 	DictionaryIterator *iter;
+	HTTPResult result;
+	DictionaryResult dict_result = DICT_OK;
+
+	if(entry->kind == HTTP_QUEUE_GET) {
+		result = http_out_get(entry->url, entry->request_id, &iter);
+		if(result != HTTP_OK) {
+			if(result != HTTP_BUSY) app_message_out_release();
+			return result;
+		}
+		int32_t nonce = pending_new_nonce();
+		if(nonce_send_key) {
+			dict_write_int32(iter, nonce_send_key, nonce);
+		}
+		if(entry->builder) {
+			entry->builder(iter, entry->builder_context);
+		}
+		result = out_send();
+		if(result == HTTP_OK) {
+			pending_add(entry->request_id, nonce);
+		}
+		return result;
+	}
+
 	AppMessageResult app_result = app_message_out_get(&iter);
 	if(app_result != APP_MSG_OK) {
 		return app_result;
 	}
-	DictionaryResult dict_result = dict_write_uint8(iter, HTTP_TIME_KEY, 1);
+	switch(entry->kind) {
+	case HTTP_QUEUE_LOCATION:
+		dict_result = dict_write_uint8(iter, HTTP_LOCATION_KEY, 1);
+		break;
+	case HTTP_QUEUE_TIME:
+		dict_result = dict_write_uint8(iter, HTTP_TIME_KEY, 1);
+		break;
+	case HTTP_QUEUE_COOKIE_FSYNC:
+		dict_result = dict_write_int32(iter, HTTP_APP_ID_KEY, our_app_id);
+		break;
+	case HTTP_QUEUE_COOKIE_GET:
+	case HTTP_QUEUE_COOKIE_DELETE:
+		dict_result = dict_write_int32(iter, entry->kind == HTTP_QUEUE_COOKIE_GET ? HTTP_COOKIE_LOAD_KEY : HTTP_COOKIE_DELETE_KEY, entry->request_id);
+		if(dict_result == DICT_OK) dict_result = dict_write_int32(iter, HTTP_APP_ID_KEY, our_app_id);
+		if(dict_result == DICT_OK) dict_result = dict_write_uint8(iter, entry->key, 1);
+		break;
+	case HTTP_QUEUE_COOKIE_SET:
+		dict_result = dict_write_int32(iter, HTTP_COOKIE_STORE_KEY, entry->request_id);
+		if(dict_result == DICT_OK) dict_result = dict_write_int32(iter, HTTP_APP_ID_KEY, our_app_id);
+		if(dict_result != DICT_OK) break;
+		switch(entry->value_type) {
+		case TUPLE_CSTRING:
+			dict_result = dict_write_cstring(iter, entry->key, (const char*)entry->value);
+			break;
+		case TUPLE_INT:
+		case TUPLE_UINT:
+			dict_result = dict_write_int(iter, entry->key, entry->value, entry->value_length, entry->value_type == TUPLE_INT);
+			break;
+		default:
+			dict_result = dict_write_data(iter, entry->key, entry->value, entry->value_length);
+			break;
+		}
+		break;
+	default:
+		break;
+	}
 	if(dict_result != DICT_OK) {
+		app_message_out_release();
 		return dict_result << 12;
 	}
-	app_result = app_message_out_send();
-	app_message_out_release();
-	return app_result;
+	return out_send();
 }
 
-// Location stuff
-HTTPResult http_location_request() {
-	DictionaryIterator *iter;
-	AppMessageResult app_result = app_message_out_get(&iter);
-	if(app_result != APP_MSG_OK) {
-		return app_result;
+static void queue_retry(void* data) {
+	queue_pump();
+}
+
+static void queue_pump() {
+	while(!out_in_flight && queue_stats.depth > 0) {
+		HTTPQueueEntry entry = queue[0];
+		HTTPResult result = queue_send(&entry);
+		// Someone else holds the outbox. Releasing it fires no callback, so
+		// try again in a later work slice rather than wait for an unrelated
+		// ack or push.
+		if(result == HTTP_BUSY) {
+			queue_stats.busy_retries++;
+			work_scheduler_defer(queue_retry, NULL);
+			return;
+		}
+
+		queue_stats.depth--;
+		memmove(&queue[0], &queue[1], queue_stats.depth * sizeof(HTTPQueueEntry));
+		if(result != HTTP_OK && http_callbacks.failure) {
+			http_callbacks.failure(entry.request_id, 1000 + result, app_callbacks.context);
+		}
 	}
-	DictionaryResult dict_result = dict_write_uint8(iter, HTTP_LOCATION_KEY, 1);
-	if(dict_result != DICT_OK) {
-		return dict_result << 12;
+}
+
+// Two requests are duplicates if sending the newer one makes the older
+// one pointless.
+static bool queue_same_request(const HTTPQueueEntry* a, const HTTPQueueEntry* b) {
+	if(a->kind != b->kind) return false;
+	switch(a->kind) {
+	case HTTP_QUEUE_GET:
+		return a->request_id == b->request_id;
+	case HTTP_QUEUE_COOKIE_GET:
+	case HTTP_QUEUE_COOKIE_SET:
+	case HTTP_QUEUE_COOKIE_DELETE:
+		return a->request_id == b->request_id && a->key == b->key;
+	default:
+		return true;
 	}
-	app_result = app_message_out_send();
-	app_message_out_release();
-	return app_result;
+}
+
+static HTTPResult queue_push(const HTTPQueueEntry* entry) {
+	for(int i = 0; i < queue_stats.depth; ++i) {
+		if(queue_same_request(&queue[i], entry)) {
+			queue[i] = *entry;
+			queue_stats.coalesced++;
+			queue_pump();
+			return HTTP_OK;
+		}
+	}
+	if(queue_stats.depth >= HTTP_QUEUE_CAPACITY) {
+		queue_stats.dropped++;
+		return HTTP_BUSY;
+	}
+	queue[queue_stats.depth++] = *entry;
+	if(queue_stats.depth > queue_stats.max_depth) {
+		queue_stats.max_depth = queue_stats.depth;
+	}
+	queue_pump();
+	return HTTP_OK;
+}
+
+HTTPResult http_queue_get(const char* url, int32_t request_id, HTTPRequestBodyBuilder builder, void* context) {
+	return queue_push(&(HTTPQueueEntry){
+		.kind = HTTP_QUEUE_GET,
+		.request_id = request_id,
+		.url = url,
+		.builder = builder,
+		.builder_context = context
+	});
+}
+
+void http_queue_stats(HTTPQueueStats* stats) {
+	*stats = queue_stats;
+}
+
+// Time stuff
+HTTPResult http_time_request() {
+	return queue_push(&(HTTPQueueEntry){ .kind = HTTP_QUEUE_TIME });
+}
+
+// Location stuff
+HTTPResult http_location_request() {
+	return queue_push(&(HTTPQueueEntry){ .kind = HTTP_QUEUE_LOCATION });
 }
 
 // Cookie stuff
@@ -316,9 +675,7 @@ HTTPResult http_cookie_set_start(int32_t request_id, DictionaryIterator **iter_o
 }
 
 HTTPResult http_cookie_set_end() {
-	AppMessageResult result = app_message_out_send();
-	app_message_out_release(); // We don't care if it's already released.
-	return result;
+	return out_send();
 }
 
 HTTPResult http_cookie_get_multiple(int32_t request_id, uint32_t* keys, int32_t length) {
@@ -347,9 +704,7 @@ HTTPResult http_cookie_get_multiple(int32_t request_id, uint32_t* keys, int32_t
 		}
 	}
 	// Send it.
-	app_result = app_message_out_send();
-	app_message_out_release();
-	return app_result;
+	return out_send();
 }
 
 HTTPResult http_cookie_delete_multiple(int32_t request_id, uint32_t* keys, int32_t length) {
@@ -378,41 +733,36 @@ HTTPResult http_cookie_delete_multiple(int32_t request_id, uint32_t* keys, int32
 		}
 	}
 	// Send it.
-	app_result = app_message_out_send();
-	app_message_out_release();
-	return app_result;
+	return out_send();
 }
 
 HTTPResult http_cookie_fsync() {
-	DictionaryIterator *iter;
-	AppMessageResult app_result = app_message_out_get(&iter);
-	if(app_result != APP_MSG_OK) {
-		return app_result;
-	}
-	DictionaryResult dict_result = dict_write_int32(iter, HTTP_APP_ID_KEY, our_app_id);
-	if(dict_result != DICT_OK) {
-		return dict_result << 12;
-	}
-	app_result = app_message_out_send();
-	app_message_out_release();
-	return app_result;
+	return queue_push(&(HTTPQueueEntry){ .kind = HTTP_QUEUE_COOKIE_FSYNC });
+}
+
+static HTTPResult queue_cookie_set(uint32_t request_id, uint32_t key, TupleType type, const void* value, uint8_t length) {
+	HTTPQueueEntry entry = {
+		.kind = HTTP_QUEUE_COOKIE_SET,
+		.request_id = request_id,
+		.key = key,
+		.value_type = type,
+		.value_length = length
+	};
+	memcpy(entry.value, value, length);
+	return queue_push(&entry);
 }
 
+// Values small enough to fit a queue entry wait their turn for the outbox;
+// bigger ones go out directly and fail with HTTP_BUSY if it is taken.
 HTTPResult http_cookie_set_int(uint32_t request_id, uint32_t key, const void* integer, uint8_t width_bytes, bool is_signed) {
-	DictionaryIterator *iter;
-	HTTPResult http_result = http_cookie_set_start(request_id, &iter);
-	if(http_result != HTTP_OK) {
-		return http_result;
-	}
-	DictionaryResult dict_result = dict_write_int(iter, key, integer, width_bytes, is_signed);
-	if(dict_result != DICT_OK) {
-		app_message_out_release();
-		return dict_result << 12;
-	}
-	return http_cookie_set_end();
+	return queue_cookie_set(request_id, key, is_signed ? TUPLE_INT : TUPLE_UINT, integer, width_bytes);
 }
 
 HTTPResult http_cookie_set_cstring(uint32_t request_id, uint32_t key, const char* value) {
+	size_t length = strlen(value) + 1;
+	if(length <= HTTP_QUEUE_VALUE_MAX) {
+		return queue_cookie_set(request_id, key, TUPLE_CSTRING, value, length);
+	}
 	DictionaryIterator *iter;
 	HTTPResult http_result = http_cookie_set_start(request_id, &iter);
 	if(http_result != HTTP_OK) {
@@ -427,6 +777,9 @@ HTTPResult http_cookie_set_cstring(uint32_t request_id, uint32_t key, const char
 }
 
 HTTPResult http_cookie_set_data(uint32_t request_id, uint32_t key, const uint8_t* const value, int length) {
+	if(length <= HTTP_QUEUE_VALUE_MAX) {
+		return queue_cookie_set(request_id, key, TUPLE_BYTE_ARRAY, value, length);
+	}
 	DictionaryIterator *iter;
 	HTTPResult http_result = http_cookie_set_start(request_id, &iter);
 	if(http_result != HTTP_OK) {
@@ -441,11 +794,11 @@ HTTPResult http_cookie_set_data(uint32_t request_id, uint32_t key, const uint8_t
 }
 
 HTTPResult http_cookie_get(uint32_t request_id, uint32_t key) {
-	return http_cookie_get_multiple(request_id, &key, 1);
+	return queue_push(&(HTTPQueueEntry){ .kind = HTTP_QUEUE_COOKIE_GET, .request_id = request_id, .key = key });
 }
 
 HTTPResult http_cookie_delete(uint32_t request_id, uint32_t key) {
-	return http_cookie_delete_multiple(request_id, &key, 1);
+	return queue_push(&(HTTPQueueEntry){ .kind = HTTP_QUEUE_COOKIE_DELETE, .request_id = request_id, .key = key });
 }
 
 HTTPResult http_cookie_set_int32(uint32_t request_id, uint32_t key, int32_t value) {
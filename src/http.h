@@ -19,7 +19,8 @@ typedef enum {
 	HTTP_NOT_ENOUGH_STORAGE				= DICT_NOT_ENOUGH_STORAGE << 12,
 	HTTP_INVALID_DICT_ARGS				= DICT_INVALID_ARGS << 12,
 	HTTP_INTERNAL_INCONSISTENCY			= DICT_INTERNAL_INCONSISTENCY << 12,
-	HTTP_INVALID_BRIDGE_RESPONSE		= 1 << 17
+	HTTP_INVALID_BRIDGE_RESPONSE		= 1 << 17,
+	HTTP_REQUEST_TIMEOUT				= 1 << 18
 } HTTPResult;
 
 // HTTP Request callbacks
@@ -37,6 +38,26 @@ typedef void(*HTTPTimeHandler)(int32_t utc_offset_seconds, bool is_dst, uint32_t
 // Location callback
 typedef void(*HTTPLocationHandler)(float latitude, float longitude, float altitude, float accuracy, void* context);
 
+// Writes the body of a queued request once the outbox is free.
+typedef void(*HTTPRequestBodyBuilder)(DictionaryIterator* body, void* context);
+
+// Outbound queue
+#define HTTP_QUEUE_CAPACITY 4
+#define HTTP_QUEUE_VALUE_MAX 16
+
+typedef struct {
+	uint8_t depth;
+	uint8_t max_depth;
+	uint16_t coalesced;
+	uint16_t dropped;
+	uint16_t busy_retries;	// pumps put off because the outbox was taken
+	uint32_t sent;
+} HTTPQueueStats;
+
+// Pending GETs awaiting a response
+#define HTTP_PENDING_CAPACITY 4
+#define HTTP_REQUEST_TIMEOUT_SECONDS 30
+
 // HTTP stuff
 typedef struct {
 	HTTPRequestFailedHandler failure;
@@ -54,6 +75,22 @@ typedef struct {
 // HTTP requests
 HTTPResult http_out_get(const char* url, int32_t request_id, DictionaryIterator **iter_out);
 HTTPResult http_out_send();
+// Queues a GET that is sent once the outbox is free. A pending GET with the
+// same request_id is replaced rather than queued twice. Returns HTTP_BUSY
+// only when the queue is full.
+HTTPResult http_queue_get(const char* url, int32_t request_id, HTTPRequestBodyBuilder builder, void* context);
+void http_queue_stats(HTTPQueueStats* stats);
+
+// Correlation for outstanding GETs. Each sent GET gets a nonce written under
+// send_key; the bridge's response echoes it under echo_key, which lets late
+// responses, failures and timeouts be matched to the request they answer.
+void http_set_nonce_keys(uint32_t send_key, uint32_t echo_key);
+// Fails every pending GET past its deadline with 1000 + HTTP_REQUEST_TIMEOUT.
+void http_check_timeouts();
+uint8_t http_pending_count();
+// Responses dropped because no pending GET matched them. Without nonce keys
+// unmatched responses are still delivered.
+uint16_t http_late_response_count();
 bool http_register_callbacks(HTTPCallbacks callbacks, void* context);
 
 // Time information
@@ -84,4 +121,8 @@ HTTPResult http_cookie_set_uint16(uint32_t request_id, uint32_t key, uint16_t va
 HTTPResult http_cookie_set_int8(uint32_t request_id, uint32_t key, int8_t value);
 HTTPResult http_cookie_set_uint8(uint32_t request_id, uint32_t key, uint8_t value);
 
+// Feeds a recorded inbound message through the normal dispatch path. Only
+// built with PERF_REPLAY.
+void http_replay_received(DictionaryIterator* received, void* context);
+
 #endif
\ No newline at end of file
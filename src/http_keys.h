@@ -0,0 +1,40 @@
+#ifndef HTTP_KEYS_H
+#define HTTP_KEYS_H
+
+// Keys reserved by the httpebble bridge protocol, one row per key:
+// X(constant, key, kind, width). kind and width describe the value as the
+// bridge sends it to the watch; width counts bytes, including the terminator
+// for strings.
+#define HTTP_TZ_NAME_MAX 32
+
+#define HTTP_RESERVED_KEYS(X) \
+	X(HTTP_URL_KEY, 0xFFFF, UINT, 1) \
+	X(HTTP_STATUS_KEY, 0xFFFE, INT, 2) \
+	X(HTTP_COOKIE_KEY, 0xFFFC, INT, 4) \
+	X(HTTP_CONNECT_KEY, 0xFFFB, UINT, 1) \
+	X(HTTP_USE_GET_KEY, 0xFFFA, UINT, 1) \
+	\
+	X(HTTP_APP_ID_KEY, 0xFFF2, INT, 4) \
+	X(HTTP_COOKIE_STORE_KEY, 0xFFF0, INT, 4) \
+	X(HTTP_COOKIE_LOAD_KEY, 0xFFF1, INT, 4) \
+	X(HTTP_COOKIE_FSYNC_KEY, 0xFFF3, UINT, 1) \
+	X(HTTP_COOKIE_DELETE_KEY, 0xFFF4, INT, 4) \
+	\
+	X(HTTP_TIME_KEY, 0xFFF5, UINT, 4) \
+	X(HTTP_UTC_OFFSET_KEY, 0xFFF6, INT, 4) \
+	X(HTTP_IS_DST_KEY, 0xFFF7, UINT, 1) \
+	X(HTTP_TZ_NAME_KEY, 0xFFF8, CSTRING, HTTP_TZ_NAME_MAX) \
+	\
+	X(HTTP_LOCATION_KEY, 0xFFE0, UINT, 4) \
+	X(HTTP_LATITUDE_KEY, 0xFFE1, UINT, 4) \
+	X(HTTP_LONGITUDE_KEY, 0xFFE2, UINT, 4) \
+	X(HTTP_ALTITUDE_KEY, 0xFFE3, UINT, 4)
+
+// Generates NAME = key and NAME_WIDTH = width for each row
+#define HTTP_KEY_CONSTANT(constant, key, kind, width) constant = key, constant##_WIDTH = width,
+
+enum {
+	HTTP_RESERVED_KEYS(HTTP_KEY_CONSTANT)
+};
+
+#endif // HTTP_KEYS_H
@@ -0,0 +1,39 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "icon_atlas.h"
+#include "config.h"
+#include "perf.h"
+
+#define ICON_ATLAS_RECT(icon, x, y, w, h) [icon] = {{x, y}, {w, h}},
+
+static const GRect ICON_ATLAS_RECTS[ATLAS_ICON_COUNT] = {
+	ICON_ATLAS_ICONS(ICON_ATLAS_RECT)
+};
+
+static BmpContainer atlas;
+static bool atlas_loaded;
+
+void icon_atlas_init() {
+	if (atlas_loaded) return;
+	bmp_init_container(RESOURCE_ID_ICON_ATLAS, &atlas);
+	atlas_loaded = true;
+}
+
+void icon_atlas_deinit() {
+	if (!atlas_loaded) return;
+	bmp_deinit_container(&atlas);
+	atlas_loaded = false;
+}
+
+void icon_atlas_sprite_init(AtlasSprite* sprite, GRect frame, AtlasIcon icon) {
+	gbitmap_init_as_sub_bitmap(&sprite->view, &atlas.bmp, ICON_ATLAS_RECTS[icon]);
+	bitmap_layer_init(&sprite->layer, frame);
+	bitmap_layer_set_bitmap(&sprite->layer, &sprite->view);
+}
+
+bool icon_atlas_sprite_set(AtlasSprite* sprite, AtlasIcon icon) {
+	if (grect_equal(&sprite->view.bounds, &ICON_ATLAS_RECTS[icon])) return false;
+	gbitmap_init_as_sub_bitmap(&sprite->view, &atlas.bmp, ICON_ATLAS_RECTS[icon]);
+	layer_mark_dirty(&sprite->layer.layer);
+	return true;
+}
@@ -0,0 +1,34 @@
+#ifndef ICON_ATLAS_H
+#define ICON_ATLAS_H
+
+#include "icon_atlas_table.h"
+
+// Every icon lives in one 1-bit bitmap, RESOURCE_ID_ICON_ATLAS, packed by
+// tools/pack_icons.py. The atlas is decoded once and stays resident. A
+// sprite is a BitmapLayer drawing one rectangle of it, so switching icons
+// only moves the source rectangle: no decode and no heap churn.
+
+#define ICON_ATLAS_ENUM(icon, x, y, w, h) icon,
+
+typedef enum {
+	ICON_ATLAS_ICONS(ICON_ATLAS_ENUM)
+	ATLAS_ICON_COUNT
+} AtlasIcon;
+
+typedef struct {
+	BitmapLayer layer;
+	GBitmap view;		// sub-bitmap of the atlas; bounds pick the icon
+} AtlasSprite;
+
+// Decodes the atlas on the first call; later calls are no-ops
+void icon_atlas_init();
+void icon_atlas_deinit();
+
+// Sets up a sprite showing icon in frame. Call icon_atlas_init first.
+void icon_atlas_sprite_init(AtlasSprite* sprite, GRect frame, AtlasIcon icon);
+
+// Points the sprite at another icon and marks it dirty. Returns false if it
+// was already showing that icon.
+bool icon_atlas_sprite_set(AtlasSprite* sprite, AtlasIcon icon);
+
+#endif // ICON_ATLAS_H
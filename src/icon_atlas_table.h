@@ -0,0 +1,24 @@
+// Generated by tools/pack_icons.py. Do not edit.
+#ifndef ICON_ATLAS_TABLE_H
+#define ICON_ATLAS_TABLE_H
+
+#define ICON_ATLAS_WIDTH 128
+#define ICON_ATLAS_HEIGHT 120
+
+// X(icon, x, y, w, h)
+#define ICON_ATLAS_ICONS(X) \
+	X(ATLAS_ICON_CLEAR_DAY, 60, 0, 30, 30) \
+	X(ATLAS_ICON_CLEAR_NIGHT, 90, 0, 30, 30) \
+	X(ATLAS_ICON_RAIN, 60, 30, 30, 30) \
+	X(ATLAS_ICON_SNOW, 90, 30, 30, 30) \
+	X(ATLAS_ICON_SLEET, 0, 60, 30, 30) \
+	X(ATLAS_ICON_WIND, 30, 60, 30, 30) \
+	X(ATLAS_ICON_FOG, 60, 60, 30, 30) \
+	X(ATLAS_ICON_CLOUDY, 90, 60, 30, 30) \
+	X(ATLAS_ICON_PARTLY_CLOUDY_DAY, 0, 90, 30, 30) \
+	X(ATLAS_ICON_PARTLY_CLOUDY_NIGHT, 30, 90, 30, 30) \
+	X(ATLAS_ICON_ERROR, 0, 0, 60, 60) \
+	X(ATLAS_ICON_EMAIL, 60, 90, 20, 20) \
+	X(ATLAS_ICON_FACEBOOK, 80, 90, 20, 20)
+
+#endif // ICON_ATLAS_TABLE_H
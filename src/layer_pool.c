@@ -0,0 +1,31 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "layer_pool.h"
+
+static PooledLayer slots[LAYER_POOL_CAPACITY];
+static bool taken[LAYER_POOL_CAPACITY];
+static LayerPoolStats stats;
+
+PooledLayer* layer_pool_acquire() {
+	for (int i = 0; i < LAYER_POOL_CAPACITY; i++) {
+		if (!taken[i]) {
+			taken[i] = true;
+			stats.in_use++;
+			if (stats.in_use > stats.peak) stats.peak = stats.in_use;
+			return &slots[i];
+		}
+	}
+	stats.exhausted++;
+	return NULL;
+}
+
+void layer_pool_release(PooledLayer* slot) {
+	int i = slot - slots;
+	if (i < 0 || i >= LAYER_POOL_CAPACITY || !taken[i]) return;
+	taken[i] = false;
+	stats.in_use--;
+}
+
+const LayerPoolStats* layer_pool_stats() {
+	return &stats;
+}
@@ -0,0 +1,33 @@
+#ifndef LAYER_POOL_H
+#define LAYER_POOL_H
+
+#include "icon_atlas.h"
+
+// Storage for sub-layers that are rarely on screen and never at the same
+// time, like the activation code and the no-link icon. A slot holds one
+// layer of either kind and goes back to the pool when that layer leaves the
+// screen, so the panel keeps LAYER_POOL_CAPACITY slots resident instead of
+// one of each.
+#define LAYER_POOL_CAPACITY 1
+
+typedef union {
+	TextLayer text;
+	AtlasSprite sprite;
+} PooledLayer;
+
+typedef struct {
+	uint8_t in_use;
+	uint8_t peak;
+	uint16_t exhausted;		// acquires refused because every slot was taken
+} LayerPoolStats;
+
+// Returns a free slot for the caller to initialise as either kind, or NULL if
+// every slot is taken.
+PooledLayer* layer_pool_acquire();
+
+// The layer must already be removed from its parent
+void layer_pool_release(PooledLayer* slot);
+
+const LayerPoolStats* layer_pool_stats();
+
+#endif // LAYER_POOL_H
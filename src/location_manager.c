@@ -0,0 +1,75 @@
+#include "pebble_os.h"
+#include "config.h"
+#include "location_manager.h"
+
+#define METERS_PER_DEGREE 111320.f
+#define RADIANS_PER_DEGREE 0.0174533f
+
+void location_manager_init(LocationManager* manager) {
+	memset(manager, 0, sizeof(LocationManager));
+	manager->interval_minutes = LOCATION_INTERVAL_DEFAULT_MINUTES;
+	manager->stretch = 1;
+}
+
+void location_manager_set_stretch(LocationManager* manager, uint8_t stretch) {
+	manager->stretch = stretch ? stretch : 1;
+}
+
+// Taylor series to the x^6 term, which avoids pulling in libm. Within 0.2%
+// up to 80 degrees and 0.7% at 85. Nearer the poles the relative error grows,
+// but it is never more than 0.001 off: a metre per kilometre of longitude at
+// the equator. Plenty for a movement threshold.
+static float approx_cos(float radians) {
+	float x2 = radians * radians;
+	return 1.f - x2 / 2.f * (1.f - x2 / 12.f * (1.f - x2 / 30.f));
+}
+
+bool location_manager_update(LocationManager* manager, float latitude, float longitude, float accuracy) {
+	int32_t new_latitude = latitude * 10000;
+	int32_t new_longitude = longitude * 10000;
+	bool moved = false;
+
+	if (manager->has_fix) {
+		// Equirectangular distance, compared squared to skip the sqrt
+		float dy = (new_latitude - manager->latitude) / 10000.f * METERS_PER_DEGREE;
+		float dx = (new_longitude - manager->longitude) / 10000.f * METERS_PER_DEGREE *
+			approx_cos(latitude * RADIANS_PER_DEGREE);
+		float threshold = LOCATION_MOVE_THRESHOLD_METERS + (accuracy > 0.f ? accuracy : 0.f);
+		moved = dx * dx + dy * dy > threshold * threshold;
+	}
+
+	if (moved) {
+		manager->interval_minutes = LOCATION_INTERVAL_MIN_MINUTES;
+		manager->moves++;
+	}
+	else if (manager->has_fix) {
+		uint16_t next = manager->interval_minutes * 2;
+		manager->interval_minutes = next > LOCATION_INTERVAL_MAX_MINUTES ? LOCATION_INTERVAL_MAX_MINUTES : next;
+	}
+
+	manager->latitude = new_latitude;
+	manager->longitude = new_longitude;
+	manager->fixed_at = time(NULL);
+	manager->has_fix = true;
+	manager->request_pending = false;
+	manager->fixes++;
+	return moved;
+}
+
+// True while the last fix is young enough to reuse, e.g. after a reconnect
+static bool location_manager_fresh(const LocationManager* manager, time_t now) {
+	return manager->has_fix && now - manager->fixed_at < manager->interval_minutes * manager->stretch * 60;
+}
+
+void location_manager_requested(LocationManager* manager, time_t now) {
+	manager->requested_at = now;
+	manager->request_pending = true;
+}
+
+bool location_manager_due(const LocationManager* manager, time_t now) {
+	// Give an unanswered request time before asking again
+	if (manager->request_pending && now - manager->requested_at < LOCATION_INTERVAL_MIN_MINUTES * 60) {
+		return false;
+	}
+	return !location_manager_fresh(manager, now);
+}
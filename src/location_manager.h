@@ -0,0 +1,35 @@
+#ifndef LOCATION_MANAGER_H
+#define LOCATION_MANAGER_H
+
+typedef struct {
+	// Degrees * 10000, the form the data request sends
+	int32_t latitude;
+	int32_t longitude;
+	time_t fixed_at;
+	// Last location request, while its reply is outstanding
+	time_t requested_at;
+	bool request_pending;
+	uint16_t interval_minutes;
+	uint8_t stretch;
+	bool has_fix;
+	uint16_t fixes;
+	uint16_t moves;
+} LocationManager;
+
+void location_manager_init(LocationManager* manager);
+
+// Records a fix and adapts the refresh interval: doubled while stationary,
+// reset to the minimum after a move. Returns true if the watch moved.
+bool location_manager_update(LocationManager* manager, float latitude, float longitude, float accuracy);
+
+// Multiplies the refresh interval, e.g. to save energy. 1 undoes it.
+void location_manager_set_stretch(LocationManager* manager, uint8_t stretch);
+
+// Call after sending a location request. location_manager_due stays false
+// until the fix arrives or LOCATION_INTERVAL_MIN_MINUTES pass without one.
+void location_manager_requested(LocationManager* manager, time_t now);
+
+// True when a new fix should be requested.
+bool location_manager_due(const LocationManager* manager, time_t now);
+
+#endif // LOCATION_MANAGER_H
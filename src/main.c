@@ -4,9 +4,21 @@
 
 #include "http.h"
 #include "util.h"
+#include "font_registry.h"
 #include "weather_layer.h"
+#include "status_board.h"
+#include "poll_scheduler.h"
+#include "replay.h"
+#include "warm_start.h"
+#include "location_manager.h"
+#include "work_scheduler.h"
+#include "energy_budget.h"
 #include "time_layer.h"
+#include "time_format.h"
 #include "config.h"
+#include "perf.h"
+#include "render_profile.h"
+#include "memory_report.h"
 
 #define MY_UUID { 0x91, 0x41, 0xB6, 0x28, 0xBC, 0x89, 0x49, 0x8E, 0xB1, 0x47, 0x04, 0x9F, 0x49, 0xC0, 0x99, 0xAD }
 
@@ -19,21 +31,6 @@ PBL_APP_INFO(MY_UUID,
 #define TIME_FRAME      (GRect(0, 2, 144, 168-6))
 #define DATE_FRAME      (GRect(1, 65, 144, 168-62))
 
-// POST variables
-#define WEATHER_KEY_LATITUDE 1
-#define WEATHER_KEY_LONGITUDE 2
-#define WEATHER_KEY_UNIT_SYSTEM 3
-	
-// Received variables
-#define WEATHER_KEY_ICON 1
-#define WEATHER_KEY_TEMPERATURE 2
-#define EMAIL_KEY_UNREAD 3
-#define SEND_VIBRATE 4
-#define ACTIVATION_CODE 5
-#define UNREAD_FACEBOOK_MESSAGES 6
-#define CHECKDIGITS 7
-	
-#define WEATHER_HTTP_COOKIE 1949327679
 #define TIME_HTTP_COOKIE 1131038289
 
 Window window;          /* main window */
@@ -45,73 +42,172 @@ GFont font_hour;        /* font for hour */
 GFont font_minute;      /* font for minute */
 
 //Weather Stuff
-static int our_latitude, our_longitude, failed_count = 0, random_number = 0;
-static bool located = false;
+static int failed_count = 0;
+static LocationManager locations;
+// Version of the last payload applied to the screen, sent back with every
+// request so the bridge can answer "not modified" instead of resending it.
+static uint32_t applied_version = 0;
+// Launch time, for logging how long the first complete status board took
+static time_t launched_at;
+static bool first_frame_logged = false;
 
 WeatherLayer weather_layer;
+static PollScheduler poll_scheduler;
+static EnergyBudget energy;
+
+// Screen updates are folded into pending_state and drawn in a later work
+// slice, so message callbacks never load icons or fonts themselves.
+static WeatherLayerState pending_state;
+static bool apply_queued = false;
+static const char SOURCE_BRIDGE[] = "bridge";
+static const char SOURCE_WARM_START[] = "warm start";
+// When the bridge last confirmed the status board. Only live data is worth
+// saving for the next launch.
+static time_t confirmed_at = 0;
 
 void request_data();
 
+void status_board_painted(const char* source) {
+	if (first_frame_logged) return;
+	first_frame_logged = true;
+#ifdef DEBUG
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "first status board from %s after %lus", source, (uint32_t)(time(NULL) - launched_at));
+#endif
+}
+
+// source is NULL for the no-link icon
+static void apply_pending(void* source) {
+	apply_queued = false;
+	bool changed = weather_layer_apply(&weather_layer, &pending_state);
+	if (changed) energy_budget_spend(&energy, ENERGY_PANEL_REDRAW);
+	if (!source) return;
+	status_board_painted(source);
+}
+
+// The state the next apply starts from
+static WeatherLayerState* next_state() {
+	if (!apply_queued) pending_state = weather_layer.state;
+	return &pending_state;
+}
+
+static void queue_apply(const char* source) {
+	apply_queued = true;
+	work_scheduler_defer(apply_pending, (void*)source);
+}
+
+static void request_data_task(void* data) {
+	request_data();
+}
+
+// The no-link icon replaces the mail icons, so forget the applied version to
+// make sure the next response repaints everything.
+void show_no_link() {
+	applied_version = 0;
+	next_state()->link_lost = true;
+	queue_apply(NULL);
+}
+
 void failed(int32_t cookie, int http_status, void* context) {
 	failed_count = failed_count + 1;
+	// Only the status board GET sets the poll cadence. Cookie store and
+	// location failures, and bridge responses too broken to name their
+	// request (cookie 0), say nothing about it.
+	if (cookie == WEATHER_HTTP_COOKIE) {
+	  poll_scheduler_failure(&poll_scheduler);
+	}
 	if (failed_count > 3) {
- 	  weather_layer_set_no_link_icon(&weather_layer);
+ 	  show_no_link();
 	}
 }
 
 void success(int32_t cookie, int http_status, DictionaryIterator* received, void* context) {
 	if(cookie != WEATHER_HTTP_COOKIE) return;
 	failed_count = 0;
+	poll_scheduler_success(&poll_scheduler);
 	
-	Tuple* checkdigits_tuple = dict_find(received, CHECKDIGITS);
+	StatusBoardUpdate update;
+	status_board_decode(received, &update);
+	if (!status_board_validate(&update)) return;
+	confirmed_at = time(NULL);
+	if (update.present & STATUS_BOARD_NOT_MODIFIED) return;
 	
-	if (checkdigits_tuple->value->int16 == random_number) {	
-		Tuple* activation_tuple = dict_find(received, ACTIVATION_CODE);
-		if (activation_tuple) {
-		  char code[4];
-		  memcpy(code, activation_tuple->value->cstring, activation_tuple->length);
-		  weather_layer_set_activation_code(&weather_layer, code);	
-	    }
-	   else {
-	  	  Tuple* icon_tuple = dict_find(received, WEATHER_KEY_ICON);
-		  if(icon_tuple) {
-			int icon = icon_tuple->value->int8;
-			if(icon >= 0 && icon < 10) {
-		       weather_layer_set_weather_icon(&weather_layer, icon);
-			} 
-		   }
-	      Tuple* temperature_tuple = dict_find(received, WEATHER_KEY_TEMPERATURE);
-	  	  if(temperature_tuple) {
-			weather_layer_set_temperature(&weather_layer, temperature_tuple->value->int16);
-		  }
-		  Tuple* email_tuple = dict_find(received, EMAIL_KEY_UNREAD);
-		  Tuple* vibrate_tuple = dict_find(received, SEND_VIBRATE);
-		  if (vibrate_tuple) {
-			if (vibrate_tuple->value->int16 == 1) {
-			  vibes_short_pulse();
-		    }
-		  }
-		  if (email_tuple) {
-		    weather_layer_set_unread_messages(&weather_layer, email_tuple->value->int16);
-		  }
-		  Tuple* facebook_tuple = dict_find(received, UNREAD_FACEBOOK_MESSAGES);
-		  if (facebook_tuple) {
-		    weather_layer_set_unread_facebook_messages(&weather_layer, facebook_tuple->value->int16);
-		  }
+	// Fold the update into the next view and draw it in one go
+	WeatherLayerState* state = next_state();
+	state->link_lost = false;
+	state->has_activation_code = (update.present & STATUS_BOARD_HAS_ACTIVATION_CODE) != 0;
+	if (state->has_activation_code) {
+	  memcpy(state->activation_code, update.activation_code, sizeof(state->activation_code));
+	}
+	else {
+	  if (update.present & STATUS_BOARD_HAS_ICON) {
+	    state->has_icon = true;
+	    state->icon = update.icon;
+	  }
+	  if (update.present & STATUS_BOARD_HAS_TEMPERATURE) {
+	    state->has_temperature = true;
+	    state->temperature = update.temperature;
+	  }
+	  if ((update.present & STATUS_BOARD_HAS_VIBRATE) && update.vibrate == 1) {
+	    vibes_short_pulse();
+	    energy_budget_spend(&energy, ENERGY_VIBRATION);
+	  }
+	  for (int i = 0; i < NOTIFICATION_SOURCE_COUNT; i++) {
+	    int32_t unread;
+	    if (status_board_get_int(&update, NOTIFICATION_SOURCE_INFO[i].response_key, &unread)) {
+	      state->has_unread |= 1 << i;
+	      state->unread[i] = unread;
 	    }
-    }
+	  }
+	}
+	queue_apply(SOURCE_BRIDGE);
+	
+	if (update.present & STATUS_BOARD_HAS_VERSION) {
+	  applied_version = update.version;
+	}
+}
+
+void cookie_loaded(int32_t request_id, Tuple* result, void* context) {
+	WeatherLayerState* state = next_state();
+	WeatherLayerState loaded = *state;
+	if (!warm_start_decode(request_id, result, &loaded)) return;
+	// Live data beat the cookie store to it
+	if (state->has_temperature || state->has_activation_code) return;
+	*state = loaded;
+	queue_apply(SOURCE_WARM_START);
 }
 
 void location(float latitude, float longitude, float altitude, float accuracy, void* context) {
-	// Fix the floats
-	our_latitude = latitude * 10000;
-	our_longitude = longitude * 10000;
-	located = true;
-	request_data();
+	// Polls already went out with the cached fix; only a first fix or a move
+	// needs a data request of its own
+	bool had_fix = locations.has_fix;
+	if (location_manager_update(&locations, latitude, longitude, accuracy) || !had_fix) {
+	  work_scheduler_defer(request_data_task, NULL);
+	}
 }
 
 void reconnect(void* context) {
-	located = false;
+	// request_data only asks for a new fix if the cached one has gone stale
+	poll_scheduler_reconnect(&poll_scheduler);
+	work_scheduler_defer(request_data_task, NULL);
+}
+
+static void poll_task(void* data) {
+	http_check_timeouts();
+	
+	// Slow the radio down while the energy budget is running low
+	energy_budget_minute(&energy);
+	uint8_t stretch = energy_budget_stretch(&energy);
+	poll_scheduler_set_stretch(&poll_scheduler, stretch);
+	location_manager_set_stretch(&locations, stretch);
+	
+	// Bridge updates reach the cookie store from here, throttled
+	if (warm_start_save(&weather_layer.state, confirmed_at)) {
+		energy_budget_spend(&energy, ENERGY_MESSAGE_SEND);
+	}
+	
+	// Skip the radio entirely while backing off from failures
+	if(!poll_scheduler_tick(&poll_scheduler)) return;
+	
 	request_data();
 }
 
@@ -119,59 +215,44 @@ void reconnect(void* context) {
 */
 void handle_minute_tick(AppContextRef ctx, PebbleTickEvent *t)
 {
-    /* Need to be static because pointers to them are stored in the text
-    * layers.
+    /* The time_format tables own the strings; the layers only keep
+    * pointers to them.
     */
-    static char date_text[] = "XXX, XXX 00";
-    static char hour_text[] = "00";
-    static char minute_text[] = ":00";
+    static const char *hour_text = NULL;
 
     (void)ctx;  /* prevent "unused parameter" warning */
 
     if (t->units_changed & DAY_UNIT)
-    {		
-	    string_format_time(date_text,
-                           sizeof(date_text),
-                           "%a, %b %d",
-                           t->tick_time);
-
-        
-		
-        text_layer_set_text(&date_layer, date_text);
+    {
+        text_layer_set_text(&date_layer, time_format_date(t->tick_time));
     }
 
-    if (clock_is_24h_style())
+    if (!hour_text || (t->units_changed & HOUR_UNIT))
     {
-        string_format_time(hour_text, sizeof(hour_text), "%H", t->tick_time);
-		if (hour_text[0] == '0')
-        {
-            /* This is a hack to get rid of the leading zero of the hour.
-            */
-            memmove(&hour_text[0], &hour_text[1], sizeof(hour_text) - 1);
-        }
+        hour_text = time_format_hour(t->tick_time, clock_is_24h_style());
     }
-    else
+
+    if (t->units_changed & HOUR_UNIT)
     {
-        string_format_time(hour_text, sizeof(hour_text), "%I", t->tick_time);
-        if (hour_text[0] == '0')
-        {
-            /* This is a hack to get rid of the leading zero of the hour.
-            */
-            memmove(&hour_text[0], &hour_text[1], sizeof(hour_text) - 1);
-        }
+        memory_report_log("hour", &weather_layer);
+#ifdef DEBUG
+        energy_budget_log(&energy, "hour");
+        poll_scheduler_log(&poll_scheduler, "hour");
+#endif
     }
 
-    string_format_time(minute_text, sizeof(minute_text), ":%M", t->tick_time);
-    time_layer_set_text(&time_layer, hour_text, minute_text);
+    time_layer_set_text(&time_layer, hour_text, time_format_minute(t->tick_time));
+	render_profile_minute();
 
-	if(!located || !(t->tick_time->tm_min % 15)) {
-	   //Every 15 minutes, update location
-	   http_location_request();
-	}
-	else {
-	    request_data();
-	}
-	
+	// Network work waits until the new time is on screen
+	work_scheduler_defer(poll_task, NULL);
+}
+
+/* Timer events drive the deferred work queue.
+*/
+void handle_timer(AppContextRef ctx, AppTimerHandle handle, uint32_t cookie)
+{
+    work_scheduler_timer(cookie);
 }
 
 
@@ -181,22 +262,17 @@ void handle_init(AppContextRef ctx)
 {
     PblTm tm;
     PebbleTickEvent t;
-    ResHandle res_d;
-    ResHandle res_h;
-    ResHandle res_m;
 
     window_init(&window, "Futura");
     window_stack_push(&window, true /* Animated */);
     window_set_background_color(&window, GColorBlack);
 
     resource_init_current_app(&APP_RESOURCES);
+	work_scheduler_init(ctx);
 
-    res_d = resource_get_handle(RESOURCE_ID_FUTURA_18);
-    res_h = resource_get_handle(RESOURCE_ID_FUTURA_CONDENSED_53);
-
-    font_date = fonts_load_custom_font(res_d);
-    font_hour = fonts_load_custom_font(res_h);
-    font_minute = fonts_load_custom_font(res_h);
+    font_date = font_registry_acquire(FONT_FUTURA_18);
+    font_hour = font_registry_acquire(FONT_FUTURA_CONDENSED_53);
+    font_minute = font_registry_acquire(FONT_FUTURA_CONDENSED_53);
     
     // Time Display
     time_layer_init(&time_layer, window.layer.frame);
@@ -215,11 +291,33 @@ void handle_init(AppContextRef ctx)
     layer_set_frame(&date_layer.layer, DATE_FRAME);
     layer_add_child(&window.layer, &date_layer.layer);
 
+	location_manager_init(&locations);
+	energy_budget_init(&energy);
+	poll_scheduler_init(&poll_scheduler, (PollPolicy){
+		.interval_minutes = POLL_INTERVAL_MINUTES,
+		.backoff_max_minutes = POLL_BACKOFF_MAX_MINUTES
+	});
+	
 	// Status Board Display
 	weather_layer_init(&weather_layer, GPoint(0, 90));
 	layer_add_child(&window.layer, &weather_layer.layer);
+	render_profile_wrap(&window.layer, RENDER_PROBE_FRAME);
+	render_profile_wrap(&time_layer.layer, RENDER_PROBE_TIME);
+	render_profile_wrap(&date_layer.layer, RENDER_PROBE_DATE);
+#ifdef PERF_COUNTERS
+	weather_layer_benchmark_temperature(&weather_layer);
+#endif
+#ifdef PERF_REPLAY
+	replay_run(24134131, (void*)ctx);
+#endif
     http_set_app_id(24134131);
-	http_register_callbacks((HTTPCallbacks){.failure=failed,.success=success,.reconnect=reconnect,.location=location}, (void*)ctx);
+	http_set_nonce_keys(WEATHER_KEY_UNIT_SYSTEM, CHECKDIGITS);
+	http_register_callbacks((HTTPCallbacks){.failure=failed,.success=success,.reconnect=reconnect,.location=location,.cookie_get=cookie_loaded}, (void*)ctx);
+	
+	// Ask for the last status board before the location request goes out
+	launched_at = time(NULL);
+	energy_budget_spend(&energy, ENERGY_MESSAGE_SEND);
+	warm_start_request();
 	
 	// Refresh time
 	srand(time(NULL));
@@ -227,15 +325,26 @@ void handle_init(AppContextRef ctx)
     t.tick_time = &tm;
     t.units_changed = SECOND_UNIT | MINUTE_UNIT | HOUR_UNIT | DAY_UNIT;
 	handle_minute_tick(ctx, &t);
+
+#ifdef PERF_COUNTERS
+	perf_log_counters("init");
+#endif
+	memory_report_log("init", &weather_layer);
 }
 
 /* Shut down the application
 */
 void handle_deinit(AppContextRef ctx)
 {
-    fonts_unload_custom_font(font_date);
-    fonts_unload_custom_font(font_hour);
-    fonts_unload_custom_font(font_minute);
+	memory_report_log("exit", &weather_layer);
+#ifdef PERF_COUNTERS
+	energy_budget_log(&energy, "exit");
+	poll_scheduler_log(&poll_scheduler, "exit");
+#endif
+
+    font_registry_release(FONT_FUTURA_18);
+    font_registry_release(FONT_FUTURA_CONDENSED_53);
+    font_registry_release(FONT_FUTURA_CONDENSED_53);
 	
 	weather_layer_deinit(&weather_layer);
 }
@@ -249,6 +358,7 @@ void pbl_main(void *params)
     {
         .init_handler = &handle_init,
         .deinit_handler = &handle_deinit,
+        .timer_handler = &handle_timer,
         .tick_info =
         {
             .tick_handler = &handle_minute_tick,
@@ -256,8 +366,8 @@ void pbl_main(void *params)
         },
 		.messaging_info = {
 			.buffer_sizes = {
-				.inbound = 124,
-				.outbound = 256,
+				.inbound = PROTOCOL_INBOUND_SIZE,
+				.outbound = PROTOCOL_OUTBOUND_SIZE,
 			}
 		}
     };
@@ -265,24 +375,36 @@ void pbl_main(void *params)
     app_event_loop(params, &handlers);
 }
 
+/* Fills in the data request body when the outbox is free. http.c adds the
+* check digits under WEATHER_KEY_UNIT_SYSTEM itself.
+*/
+void write_request_body(DictionaryIterator* body, void* context) {
+	StatusBoardRequest request = {
+		.latitude = locations.latitude,
+		.longitude = locations.longitude,
+		.version = applied_version,
+		// Tells the bridge we can read STATUS_BOARD_PACKED; servers that don't
+		// know the key keep sending separate tuples.
+		.packed_format = STATUS_BOARD_PACKED_VERSION,
+	};
+	status_board_encode(body, &request);
+}
+
 void request_data() {
-	if (!located) {
+	time_t now = time(NULL);
+	if (location_manager_due(&locations, now)) {
+	  energy_budget_spend(&energy, ENERGY_LOCATION_REQUEST);
 	  http_location_request();
-	  return;
+	  location_manager_requested(&locations, now);
 	}
-	DictionaryIterator *body;
-	HTTPResult result = http_out_get("https://pebbleboard.com/get_data",WEATHER_HTTP_COOKIE, &body);
-	if (result != HTTP_OK) {
-       weather_layer_set_no_link_icon(&weather_layer);
- 	   return;
+	// Without any fix there is nothing to ask for yet; the location reply
+	// calls back into request_data. Otherwise the cached fix will do.
+	if (!locations.has_fix) return;
+	if (http_queue_get(STATUS_BOARD_URL, WEATHER_HTTP_COOKIE, write_request_body, NULL) == HTTP_OK) {
+	  energy_budget_spend(&energy, ENERGY_MESSAGE_SEND);
 	}
-	random_number = rand() % 2000;
-	dict_write_int32(body, WEATHER_KEY_LATITUDE, our_latitude);
-	dict_write_int32(body, WEATHER_KEY_LONGITUDE, our_longitude);
-	dict_write_int32(body, WEATHER_KEY_UNIT_SYSTEM, random_number);
-	
-	if (http_out_send() != HTTP_OK) {
-	  weather_layer_set_no_link_icon(&weather_layer);
-	  return;
+	else {
+	  poll_scheduler_failure(&poll_scheduler);
+	  show_no_link();
 	}
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "http.h"
+#include "time_layer.h"
+#include "weather_layer.h"
+#include "status_board.h"
+#include "warm_start.h"
+#include "font_registry.h"
+#include "config.h"
+#include "perf.h"
+#include "memory_report.h"
+
+#ifdef MEMORY_REPORT
+
+#define MEMORY_REPORT_STRUCTS(X) \
+	X(WeatherLayer) \
+	X(WeatherLayerState) \
+	X(NotificationSlot) \
+	X(AtlasSprite) \
+	X(PooledLayer) \
+	X(TimeLayer) \
+	X(TextLayer) \
+	X(BmpContainer) \
+	X(StatusBoardUpdate) \
+	X(WarmStartRecord)
+
+#define LOG_STRUCT_SIZE(type) \
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s sizeof(%s)=%u", label, #type, sizeof(type));
+
+void memory_report_log(const char* label, const WeatherLayer* weather_layer) {
+	MEMORY_REPORT_STRUCTS(LOG_STRUCT_SIZE)
+	
+	// Pooling keeps one union slot resident in place of a TextLayer and an
+	// AtlasSprite of their own
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s layer_pool saves=%d bytes", label,
+		(int)(sizeof(TextLayer) + sizeof(AtlasSprite)) - (int)(LAYER_POOL_CAPACITY * sizeof(PooledLayer)));
+	
+	const LayerPoolStats* pool = layer_pool_stats();
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s layer_pool in_use=%u peak=%u exhausted=%u",
+		label, pool->in_use, pool->peak, pool->exhausted);
+
+	// A max_depth short of the capacity with nothing dropped means the queue
+	// could be smaller
+	HTTPQueueStats queue;
+	http_queue_stats(&queue);
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s http_queue depth=%u max_depth=%u capacity=%u coalesced=%u dropped=%u busy_retries=%u sent=%lu",
+		label, queue.depth, queue.max_depth, HTTP_QUEUE_CAPACITY, queue.coalesced, queue.dropped, queue.busy_retries, queue.sent);
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s http_pending in_use=%u capacity=%u late=%u",
+		label, http_pending_count(), HTTP_PENDING_CAPACITY, http_late_response_count());
+
+	const PerfBitmaps* bitmaps = perf_bitmaps();
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s bitmaps resident=%u peak=%u heap=%lu peak_heap=%lu",
+		label, bitmaps->resident, bitmaps->peak, bitmaps->bytes, bitmaps->peak_bytes);
+	
+	uint16_t font_loads = font_registry_load_count();
+	uint16_t font_unloads = font_registry_unload_count();
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s fonts resident=%u loads=%u unloads=%u",
+		label, font_loads - font_unloads, font_loads, font_unloads);
+	
+	// Sprites draw from the one atlas bitmap counted above
+	int sprites = weather_layer->has_weather_icon + weather_layer->has_no_link_icon;
+	for (int i = 0; i < NOTIFICATION_SOURCE_COUNT; i++) {
+		sprites += weather_layer->notifications[i].has_icon;
+	}
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s atlas %dx%d sprites=%d", label,
+		ICON_ATLAS_WIDTH, ICON_ATLAS_HEIGHT, sprites);
+	
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "memory %s malloc calls=%lu", label, perf_counters[PERF_HEAP_ALLOC]);
+}
+
+#endif // MEMORY_REPORT
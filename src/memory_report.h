@@ -0,0 +1,25 @@
+#ifndef MEMORY_REPORT_H
+#define MEMORY_REPORT_H
+
+// RAM footprint report. Define MEMORY_REPORT in config.h to enable it, and
+// include this header after config.h so the calls compile away otherwise.
+// Logs the size of the app's main structs, which is fixed at build time, and
+// what is resident right now: decoded bitmaps and their heap bytes, custom
+// fonts, the layer pool, the HTTP outbound queue and pending GETs, and the
+// icon sprites on screen, with peaks since launch.
+
+#if defined(MEMORY_REPORT) && !defined(PERF_COUNTERS)
+#error "MEMORY_REPORT needs PERF_COUNTERS"
+#endif
+
+#ifdef MEMORY_REPORT
+
+void memory_report_log(const char* label, const WeatherLayer* weather_layer);
+
+#else
+
+#define memory_report_log(label, weather_layer)
+
+#endif // MEMORY_REPORT
+
+#endif // MEMORY_REPORT_H
@@ -0,0 +1,13 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "status_board.h"
+#include "notification_source.h"
+
+#define NOTIFICATION_SOURCE_ROW(source, icon, key) [source] = { icon, key },
+
+const NotificationSourceInfo NOTIFICATION_SOURCE_INFO[NOTIFICATION_SOURCE_COUNT] = {
+	NOTIFICATION_SOURCES(NOTIFICATION_SOURCE_ROW)
+};
+
+// WeatherLayerState keeps one presence bit per source
+typedef char notification_source_bits[NOTIFICATION_SOURCE_COUNT <= 8 ? 1 : -1];
@@ -0,0 +1,41 @@
+#ifndef NOTIFICATION_SOURCE_H
+#define NOTIFICATION_SOURCE_H
+
+#include "icon_atlas.h"
+
+// Unread counts shown down the left side of the panel, one row per source:
+// X(source, atlas icon, response key). Every row shares the layout, the
+// count font and the setter. Adding a source takes a line here, its icon in
+// tools/pack_icons.py and its key in protocol.h.
+//
+// Each source costs one NotificationSlot in WeatherLayer (a region Layer, a
+// TextLayer, an AtlasSprite and a 5 byte string) and 2 bytes in
+// WeatherLayerState and in the warm start record. Its icon adds 20x20 bits to
+// the shared atlas. weather_layer_init logs the exact struct sizes under
+// DEBUG.
+#define NOTIFICATION_SOURCES(X) \
+	X(NOTIFICATION_EMAIL, ATLAS_ICON_EMAIL, EMAIL_KEY_UNREAD) \
+	X(NOTIFICATION_FACEBOOK, ATLAS_ICON_FACEBOOK, UNREAD_FACEBOOK_MESSAGES)
+
+#define NOTIFICATION_SOURCE_ENUM(source, icon, key) source,
+
+typedef enum {
+	NOTIFICATION_SOURCES(NOTIFICATION_SOURCE_ENUM)
+	NOTIFICATION_SOURCE_COUNT
+} NotificationSource;
+
+typedef struct {
+	AtlasIcon icon;
+	uint32_t response_key;
+} NotificationSourceInfo;
+
+extern const NotificationSourceInfo NOTIFICATION_SOURCE_INFO[NOTIFICATION_SOURCE_COUNT];
+
+// The rows split the panel height evenly. The icon and count in each row
+// keep the original mail and Facebook positions, 19 and 50 down the
+// weather layer; more sources spread over the same span.
+#define NOTIFICATION_ROW_HEIGHT (68 / NOTIFICATION_SOURCE_COUNT)
+#define NOTIFICATION_CONTENT_TOP 19
+#define NOTIFICATION_CONTENT_PITCH (62 / NOTIFICATION_SOURCE_COUNT)
+
+#endif // NOTIFICATION_SOURCE_H
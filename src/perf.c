@@ -0,0 +1,74 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "config.h"
+#include "perf.h"
+
+#ifdef PERF_COUNTERS
+
+uint32_t perf_counters[PERF_COUNTER_COUNT];
+
+static const char* PERF_COUNTER_NAMES[PERF_COUNTER_COUNT] = {
+	"layer_mark_dirty",
+	"text_layer_set_text",
+	"fonts_load_custom_font",
+	"bmp_init_container",
+	"bmp_deinit_container",
+	"app_message_out_send",
+	"string_format_time",
+	"malloc",
+	"dirty_pixels",
+};
+
+void perf_log_counters(const char* label) {
+	for (int i = 0; i < PERF_COUNTER_COUNT; i++) {
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "%s %s=%lu", label, PERF_COUNTER_NAMES[i], perf_counters[i]);
+	}
+}
+
+const char* perf_counter_name(PerfCounter counter) {
+	return PERF_COUNTER_NAMES[counter];
+}
+
+static PerfBitmaps bitmaps;
+
+static uint32_t bitmap_bytes(const BmpContainer* container) {
+	return container->bmp.row_size_bytes * container->bmp.bounds.size.h;
+}
+
+bool perf_bitmap_loaded(const BmpContainer* container, bool loaded) {
+	if (!loaded) return false;
+	bitmaps.resident++;
+	bitmaps.bytes += bitmap_bytes(container);
+	if (bitmaps.resident > bitmaps.peak) bitmaps.peak = bitmaps.resident;
+	if (bitmaps.bytes > bitmaps.peak_bytes) bitmaps.peak_bytes = bitmaps.bytes;
+	return true;
+}
+
+void perf_bitmap_unloaded(const BmpContainer* container) {
+	if (bitmaps.resident == 0) return;
+	bitmaps.resident--;
+	bitmaps.bytes -= bitmap_bytes(container);
+}
+
+const PerfBitmaps* perf_bitmaps() {
+	return &bitmaps;
+}
+
+#ifndef HOST_BUILD
+#define DEMCR (*(volatile uint32_t*)0xE000EDFC)
+#define DEMCR_TRCENA (1 << 24)
+#define DWT_CTRL (*(volatile uint32_t*)0xE0001000)
+#define DWT_CTRL_CYCCNTENA (1 << 0)
+#define DWT_CYCCNT (*(volatile uint32_t*)0xE0001004)
+
+void perf_cycles_init() {
+	DEMCR |= DEMCR_TRCENA;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t perf_cycles() {
+	return DWT_CYCCNT;
+}
+#endif // HOST_BUILD
+
+#endif // PERF_COUNTERS
@@ -0,0 +1,74 @@
+#ifndef PERF_H
+#define PERF_H
+
+// Hot-path counters for measuring what one minute of the face costs on the
+// watch. Define PERF_COUNTERS in config.h to enable them. Include this header
+// after the Pebble headers so the SDK calls below are routed through the
+// counters; only calls made by this app are counted, not the ones the
+// firmware makes internally.
+
+typedef enum {
+	PERF_LAYER_MARK_DIRTY = 0,
+	PERF_TEXT_SET,
+	PERF_FONT_LOAD,
+	PERF_BMP_INIT,
+	PERF_BMP_DEINIT,
+	PERF_MESSAGE_SEND,
+	PERF_FORMAT_TIME,
+	PERF_HEAP_ALLOC,
+	PERF_DIRTY_PIXELS,	// area of the regions invalidated by the app
+	PERF_COUNTER_COUNT
+} PerfCounter;
+
+#if defined(PERF_REPLAY) && !defined(PERF_COUNTERS)
+#error "PERF_REPLAY needs PERF_COUNTERS"
+#endif
+
+#ifdef PERF_COUNTERS
+
+extern uint32_t perf_counters[PERF_COUNTER_COUNT];
+
+#define PERF_COUNT(counter) (perf_counters[counter]++)
+#define PERF_ADD(counter, n) (perf_counters[counter] += (n))
+
+#define layer_mark_dirty(layer) (PERF_COUNT(PERF_LAYER_MARK_DIRTY), layer_mark_dirty(layer))
+#define text_layer_set_text(layer, text) (PERF_COUNT(PERF_TEXT_SET), text_layer_set_text(layer, text))
+#define fonts_load_custom_font(handle) (PERF_COUNT(PERF_FONT_LOAD), fonts_load_custom_font(handle))
+#define bmp_init_container(id, container) (PERF_COUNT(PERF_BMP_INIT), \
+	perf_bitmap_loaded(container, bmp_init_container(id, container)))
+#define bmp_deinit_container(container) (PERF_COUNT(PERF_BMP_DEINIT), \
+	perf_bitmap_unloaded(container), bmp_deinit_container(container))
+#define app_message_out_send() (PERF_COUNT(PERF_MESSAGE_SEND), app_message_out_send())
+#define string_format_time(buf, size, format, time) (PERF_COUNT(PERF_FORMAT_TIME), string_format_time(buf, size, format, time))
+#define malloc(size) (PERF_COUNT(PERF_HEAP_ALLOC), malloc(size))
+
+void perf_log_counters(const char* label);
+const char* perf_counter_name(PerfCounter counter);
+
+// Decoded bitmaps held by the app. Their pixels live on the app heap, which
+// the app otherwise leaves alone, so bytes here is the heap in use.
+typedef struct {
+	uint16_t resident;
+	uint16_t peak;
+	uint32_t bytes;
+	uint32_t peak_bytes;
+} PerfBitmaps;
+
+bool perf_bitmap_loaded(const BmpContainer* container, bool loaded);
+void perf_bitmap_unloaded(const BmpContainer* container);
+const PerfBitmaps* perf_bitmaps();
+
+// Free-running CPU cycle counter (the Cortex-M3 DWT unit), for timing code
+// paths too short for the one-second system clock. The host build counts
+// nanoseconds instead; see host/pebble_shim.c.
+void perf_cycles_init();
+uint32_t perf_cycles();
+
+#else
+
+#define PERF_COUNT(counter)
+#define PERF_ADD(counter, n)
+
+#endif // PERF_COUNTERS
+
+#endif // PERF_H
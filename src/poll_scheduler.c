@@ -0,0 +1,57 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "poll_scheduler.h"
+
+void poll_scheduler_init(PollScheduler* scheduler, PollPolicy policy) {
+	memset(scheduler, 0, sizeof(PollScheduler));
+	if (policy.interval_minutes == 0) policy.interval_minutes = 1;
+	if (policy.backoff_max_minutes < policy.interval_minutes) {
+		policy.backoff_max_minutes = policy.interval_minutes;
+	}
+	scheduler->policy = policy;
+	scheduler->current_interval = policy.interval_minutes;
+	scheduler->stretch = 1;
+	// Fire on the very first tick
+	scheduler->minutes_waited = policy.interval_minutes - 1;
+}
+
+bool poll_scheduler_tick(PollScheduler* scheduler) {
+	scheduler->minutes_waited++;
+	if (scheduler->minutes_waited < scheduler->current_interval * scheduler->stretch) {
+		scheduler->requests_saved++;
+		return false;
+	}
+	scheduler->minutes_waited = 0;
+	scheduler->requests_made++;
+	return true;
+}
+
+void poll_scheduler_success(PollScheduler* scheduler) {
+	scheduler->failures = 0;
+	scheduler->current_interval = scheduler->policy.interval_minutes;
+}
+
+void poll_scheduler_failure(PollScheduler* scheduler) {
+	scheduler->failures++;
+	uint16_t next = scheduler->current_interval * 2;
+	if (next > scheduler->policy.backoff_max_minutes) {
+		next = scheduler->policy.backoff_max_minutes;
+	}
+	scheduler->current_interval = next;
+}
+
+void poll_scheduler_set_stretch(PollScheduler* scheduler, uint8_t stretch) {
+	scheduler->stretch = stretch ? stretch : 1;
+}
+
+void poll_scheduler_reconnect(PollScheduler* scheduler) {
+	poll_scheduler_success(scheduler);
+	scheduler->minutes_waited = 0;
+	scheduler->requests_made++;
+}
+
+void poll_scheduler_log(const PollScheduler* scheduler, const char* label) {
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "poll %s made=%lu saved=%lu interval=%u stretch=%u failures=%u",
+		label, scheduler->requests_made, scheduler->requests_saved,
+		scheduler->current_interval, scheduler->stretch, scheduler->failures);
+}
@@ -0,0 +1,38 @@
+#ifndef POLL_SCHEDULER_H
+#define POLL_SCHEDULER_H
+
+typedef struct {
+	uint16_t interval_minutes;
+	uint16_t backoff_max_minutes;
+} PollPolicy;
+
+typedef struct {
+	PollPolicy policy;
+	uint16_t current_interval;
+	uint16_t minutes_waited;
+	uint16_t failures;
+	uint8_t stretch;
+	uint32_t requests_made;
+	uint32_t requests_saved;
+} PollScheduler;
+
+void poll_scheduler_init(PollScheduler* scheduler, PollPolicy policy);
+
+// Call once a minute. Returns true when a request should go out now; every
+// false return is counted as a saved request.
+bool poll_scheduler_tick(PollScheduler* scheduler);
+
+// Feed request outcomes back in. Failures double the interval up to the
+// policy ceiling, a success or a reconnect restores the normal cadence.
+void poll_scheduler_success(PollScheduler* scheduler);
+void poll_scheduler_failure(PollScheduler* scheduler);
+void poll_scheduler_reconnect(PollScheduler* scheduler);
+
+// Multiplies the current interval, backoff included, e.g. to save energy.
+// 1 restores the policy's cadence.
+void poll_scheduler_set_stretch(PollScheduler* scheduler, uint8_t stretch);
+
+// Logs the requests made and saved so far and the interval in force
+void poll_scheduler_log(const PollScheduler* scheduler, const char* label);
+
+#endif // POLL_SCHEDULER_H
@@ -0,0 +1,153 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "http.h"
+#include "http_keys.h"
+
+// The status board protocol in one place. Key constants, the request and
+// response structs, the encoder, the decoder and the AppMessage buffer sizes
+// are all generated from the tables below, so a change here reaches every
+// part of the app.
+//
+// Rows are X(constant, key, member, kind, width[, flag]). width is the value
+// size in bytes, including the terminator for strings. kind is one of
+//   INT, UINT  integer of the given width
+//   CSTRING    string of at most width - 1 characters
+//   PACKED     byte array holding other fields, see status_board.h
+//   NONCE      integer written and matched by http.c; the encoder skips it
+
+#define STATUS_BOARD_URL "https://pebbleboard.com/get_data"
+// Request id of data requests, which the bridge echoes as the HTTP cookie
+#define WEATHER_HTTP_COOKIE 1949327679
+
+// POST variables
+#define STATUS_BOARD_REQUEST_FIELDS(X) \
+	X(WEATHER_KEY_LATITUDE, 1, latitude, INT, 4) \
+	X(WEATHER_KEY_LONGITUDE, 2, longitude, INT, 4) \
+	X(WEATHER_KEY_UNIT_SYSTEM, 3, nonce, NONCE, 4) \
+	X(WEATHER_KEY_VERSION, 4, version, UINT, 4) \
+	X(WEATHER_KEY_PACKED_FORMAT, 5, packed_format, UINT, 1)
+
+// Received variables. Row order is the bit order of StatusBoardField, which
+// the presence byte of the packed format relies on.
+#define STATUS_BOARD_PACKED_SIZE 14
+
+#define STATUS_BOARD_RESPONSE_FIELDS(X) \
+	X(WEATHER_KEY_ICON, 1, icon, INT, 1, STATUS_BOARD_HAS_ICON) \
+	X(WEATHER_KEY_TEMPERATURE, 2, temperature, INT, 2, STATUS_BOARD_HAS_TEMPERATURE) \
+	X(EMAIL_KEY_UNREAD, 3, unread_email, INT, 2, STATUS_BOARD_HAS_UNREAD_EMAIL) \
+	X(SEND_VIBRATE, 4, vibrate, INT, 2, STATUS_BOARD_HAS_VIBRATE) \
+	X(ACTIVATION_CODE, 5, activation_code, CSTRING, 5, STATUS_BOARD_HAS_ACTIVATION_CODE) \
+	X(UNREAD_FACEBOOK_MESSAGES, 6, unread_facebook, INT, 2, STATUS_BOARD_HAS_UNREAD_FACEBOOK) \
+	X(CHECKDIGITS, 7, checkdigits, NONCE, 2, STATUS_BOARD_HAS_CHECKDIGITS) \
+	X(PAYLOAD_VERSION, 8, version, UINT, 4, STATUS_BOARD_HAS_VERSION) \
+	X(NOT_MODIFIED, 9, not_modified, UINT, 1, STATUS_BOARD_NOT_MODIFIED) \
+	X(STATUS_BOARD_PACKED, 10, packed, PACKED, STATUS_BOARD_PACKED_SIZE, STATUS_BOARD_HAS_PACKED)
+
+// Key constants: NAME = key, NAME_WIDTH = width
+#define PROTOCOL_KEY(constant, key, member, kind, width, ...) constant = key, constant##_WIDTH = width,
+
+enum {
+	STATUS_BOARD_REQUEST_FIELDS(PROTOCOL_KEY)
+	STATUS_BOARD_RESPONSE_FIELDS(PROTOCOL_KEY)
+};
+
+// Presence bits for StatusBoardUpdate.present, one per response row
+#define PROTOCOL_FLAG_INDEX(constant, key, member, kind, width, flag) flag##_INDEX,
+#define PROTOCOL_FLAG(constant, key, member, kind, width, flag) flag = 1 << flag##_INDEX,
+
+enum {
+	STATUS_BOARD_RESPONSE_FIELDS(PROTOCOL_FLAG_INDEX)
+	STATUS_BOARD_FIELD_COUNT
+};
+
+typedef enum {
+	STATUS_BOARD_RESPONSE_FIELDS(PROTOCOL_FLAG)
+} StatusBoardField;
+
+// Struct members. Integers are stored at their wire width.
+typedef int8_t protocol_int1;
+typedef int16_t protocol_int2;
+typedef int32_t protocol_int4;
+typedef uint8_t protocol_uint1;
+typedef uint16_t protocol_uint2;
+typedef uint32_t protocol_uint4;
+
+#define PROTOCOL_MEMBER_INT(member, width) protocol_int##width member;
+#define PROTOCOL_MEMBER_UINT(member, width) protocol_uint##width member;
+#define PROTOCOL_MEMBER_CSTRING(member, width) char member[width];
+#define PROTOCOL_MEMBER_PACKED(member, width)
+#define PROTOCOL_MEMBER_NONCE(member, width) protocol_int##width member;
+#define PROTOCOL_REQUEST_MEMBER(constant, key, member, kind, width) PROTOCOL_MEMBER_##kind(member, width)
+#define PROTOCOL_RESPONSE_MEMBER(constant, key, member, kind, width, flag) PROTOCOL_MEMBER_##kind(member, width)
+
+// The body of a data request. http.c writes the nonce itself.
+typedef struct {
+	STATUS_BOARD_REQUEST_FIELDS(PROTOCOL_REQUEST_MEMBER)
+} StatusBoardRequest;
+
+// A bridge response decoded in one walk over the dictionary. Only the fields
+// whose bit is set in present carry a value.
+typedef struct {
+	uint16_t present;
+	STATUS_BOARD_RESPONSE_FIELDS(PROTOCOL_RESPONSE_MEMBER)
+} StatusBoardUpdate;
+
+// Buffer sizes, as dict_calc_buffer_size would count them: a one byte tuple
+// count, then a 7 byte header (key, type, length) in front of each value.
+#define PROTOCOL_DICT_HEADER_SIZE 1
+#define PROTOCOL_TUPLE_HEADER_SIZE 7
+#define PROTOCOL_TUPLE(width) (PROTOCOL_TUPLE_HEADER_SIZE + (width))
+#define PROTOCOL_KEY_TUPLE(constant) PROTOCOL_TUPLE(constant##_WIDTH)
+#define PROTOCOL_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+// The packed blob stands in for the tuples it carries, so it never adds to
+// the worst case of a response.
+#define PROTOCOL_TUPLE_SIZE_INT(width) + PROTOCOL_TUPLE(width)
+#define PROTOCOL_TUPLE_SIZE_UINT(width) + PROTOCOL_TUPLE(width)
+#define PROTOCOL_TUPLE_SIZE_CSTRING(width) + PROTOCOL_TUPLE(width)
+#define PROTOCOL_TUPLE_SIZE_PACKED(width)
+#define PROTOCOL_TUPLE_SIZE_NONCE(width) + PROTOCOL_TUPLE(width)
+#define PROTOCOL_REQUEST_SIZE(constant, key, member, kind, width) PROTOCOL_TUPLE_SIZE_##kind(width)
+#define PROTOCOL_RESPONSE_SIZE(constant, key, member, kind, width, flag) PROTOCOL_TUPLE_SIZE_##kind(width)
+
+#define STATUS_BOARD_REQUEST_SIZE (0 STATUS_BOARD_REQUEST_FIELDS(PROTOCOL_REQUEST_SIZE))
+#define STATUS_BOARD_RESPONSE_SIZE (0 STATUS_BOARD_RESPONSE_FIELDS(PROTOCOL_RESPONSE_SIZE))
+
+// Everything the bridge can send us
+#define PROTOCOL_HTTP_RESPONSE_SIZE (PROTOCOL_DICT_HEADER_SIZE + \
+	PROTOCOL_KEY_TUPLE(HTTP_URL_KEY) + PROTOCOL_KEY_TUPLE(HTTP_STATUS_KEY) + \
+	PROTOCOL_KEY_TUPLE(HTTP_COOKIE_KEY) + PROTOCOL_KEY_TUPLE(HTTP_APP_ID_KEY) + \
+	STATUS_BOARD_RESPONSE_SIZE)
+#define PROTOCOL_TIME_RESPONSE_SIZE (PROTOCOL_DICT_HEADER_SIZE + \
+	PROTOCOL_KEY_TUPLE(HTTP_TIME_KEY) + PROTOCOL_KEY_TUPLE(HTTP_UTC_OFFSET_KEY) + \
+	PROTOCOL_KEY_TUPLE(HTTP_IS_DST_KEY) + PROTOCOL_KEY_TUPLE(HTTP_TZ_NAME_KEY))
+#define PROTOCOL_LOCATION_RESPONSE_SIZE (PROTOCOL_DICT_HEADER_SIZE + \
+	PROTOCOL_KEY_TUPLE(HTTP_LOCATION_KEY) + PROTOCOL_KEY_TUPLE(HTTP_LATITUDE_KEY) + \
+	PROTOCOL_KEY_TUPLE(HTTP_LONGITUDE_KEY) + PROTOCOL_KEY_TUPLE(HTTP_ALTITUDE_KEY))
+#define PROTOCOL_COOKIE_RESPONSE_SIZE (PROTOCOL_DICT_HEADER_SIZE + \
+	PROTOCOL_KEY_TUPLE(HTTP_COOKIE_LOAD_KEY) + PROTOCOL_KEY_TUPLE(HTTP_APP_ID_KEY) + \
+	PROTOCOL_TUPLE(HTTP_QUEUE_VALUE_MAX))
+
+// Everything we send the bridge. The URL goes out as a string.
+#define PROTOCOL_HTTP_REQUEST_SIZE (PROTOCOL_DICT_HEADER_SIZE + \
+	PROTOCOL_TUPLE(sizeof(STATUS_BOARD_URL)) + PROTOCOL_KEY_TUPLE(HTTP_COOKIE_KEY) + \
+	PROTOCOL_KEY_TUPLE(HTTP_APP_ID_KEY) + STATUS_BOARD_REQUEST_SIZE)
+#define PROTOCOL_COOKIE_REQUEST_SIZE (PROTOCOL_DICT_HEADER_SIZE + \
+	PROTOCOL_KEY_TUPLE(HTTP_COOKIE_STORE_KEY) + PROTOCOL_KEY_TUPLE(HTTP_APP_ID_KEY) + \
+	PROTOCOL_TUPLE(HTTP_QUEUE_VALUE_MAX))
+
+#define PROTOCOL_INBOUND_SIZE PROTOCOL_MAX(PROTOCOL_MAX(PROTOCOL_HTTP_RESPONSE_SIZE, PROTOCOL_TIME_RESPONSE_SIZE), \
+	PROTOCOL_MAX(PROTOCOL_LOCATION_RESPONSE_SIZE, PROTOCOL_COOKIE_RESPONSE_SIZE))
+#define PROTOCOL_OUTBOUND_SIZE PROTOCOL_MAX(PROTOCOL_HTTP_REQUEST_SIZE, PROTOCOL_COOKIE_REQUEST_SIZE)
+
+// Largest buffers the firmware will hand an app
+#define PROTOCOL_INBOUND_LIMIT 124
+#define PROTOCOL_OUTBOUND_LIMIT 256
+
+typedef char protocol_inbound_fits[PROTOCOL_INBOUND_SIZE <= PROTOCOL_INBOUND_LIMIT ? 1 : -1];
+typedef char protocol_outbound_fits[PROTOCOL_OUTBOUND_SIZE <= PROTOCOL_OUTBOUND_LIMIT ? 1 : -1];
+typedef char protocol_packed_fits[STATUS_BOARD_FIELD_COUNT <= 16 &&
+	PROTOCOL_TUPLE(STATUS_BOARD_PACKED_SIZE) <= STATUS_BOARD_RESPONSE_SIZE ? 1 : -1];
+
+#endif // PROTOCOL_H
@@ -0,0 +1,104 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "config.h"
+#include "perf.h"
+#include "render_profile.h"
+
+#ifdef PROFILE_RENDER
+
+#ifdef DEBUG
+static const char* RENDER_PROBE_NAMES[RENDER_PROBE_COUNT] = {
+	"frame",
+	"time",
+	"date",
+	"regions",
+	"temperature",
+	"notification_count",
+	"activation_code",
+	"notification_icon",
+	"no_link_icon",
+	"weather_icon",
+};
+#endif
+
+typedef struct {
+	Layer* layer;
+	LayerUpdateProc update_proc;
+	RenderProbe probe;
+} RenderProfileLayer;
+
+static RenderProfileLayer layers[RENDER_PROFILE_LAYERS];
+static uint8_t layer_count;
+
+// Ring of per-frame cycle totals; current is the frame being drawn
+static uint32_t frames[RENDER_PROFILE_FRAMES][RENDER_PROBE_COUNT];
+static uint8_t frame_head, frame_count;
+static uint32_t current[RENDER_PROBE_COUNT];
+static bool frame_open;
+static uint16_t frames_this_minute;
+
+static void close_frame() {
+	if (frame_open) {
+		memcpy(frames[frame_head], current, sizeof(current));
+		frame_head = (frame_head + 1) % RENDER_PROFILE_FRAMES;
+		if (frame_count < RENDER_PROFILE_FRAMES) frame_count++;
+	}
+	memset(current, 0, sizeof(current));
+	frame_open = true;
+	frames_this_minute++;
+}
+
+static void trampoline(Layer* layer, GContext* ctx) {
+	for (int i = 0; i < layer_count; i++) {
+		if (layers[i].layer != layer) continue;
+		if (layers[i].probe == RENDER_PROBE_FRAME) close_frame();
+		if (!layers[i].update_proc) return;
+		uint32_t start = perf_cycles();
+		layers[i].update_proc(layer, ctx);
+		current[layers[i].probe] += perf_cycles() - start;
+		return;
+	}
+}
+
+void render_profile_wrap(Layer* layer, RenderProbe probe) {
+	if (layer->update_proc == trampoline) return;
+	perf_cycles_init();
+	
+	int i = 0;
+	while (i < layer_count && layers[i].layer != layer) i++;
+	if (i == layer_count) {
+		if (layer_count == RENDER_PROFILE_LAYERS) return;
+		layer_count++;
+	}
+	layers[i].layer = layer;
+	layers[i].update_proc = layer->update_proc;
+	layers[i].probe = probe;
+	layer->update_proc = trampoline;
+}
+
+#ifdef DEBUG
+static void sort(uint32_t* values, int count) {
+	for (int i = 1; i < count; i++) {
+		uint32_t value = values[i];
+		int j = i;
+		for (; j > 0 && values[j - 1] > value; j--) values[j] = values[j - 1];
+		values[j] = value;
+	}
+}
+#endif
+
+void render_profile_minute() {
+#ifdef DEBUG
+	uint32_t column[RENDER_PROFILE_FRAMES];
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "render frames/min=%u", frames_this_minute);
+	for (int probe = 0; probe < RENDER_PROBE_COUNT && frame_count; probe++) {
+		for (int i = 0; i < frame_count; i++) column[i] = frames[i][probe];
+		sort(column, frame_count);
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "render %s p50=%lu p99=%lu cycles", RENDER_PROBE_NAMES[probe],
+			column[frame_count / 2], column[(frame_count * 99) / 100]);
+	}
+#endif
+	frames_this_minute = 0;
+}
+
+#endif // PROFILE_RENDER
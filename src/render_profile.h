@@ -0,0 +1,49 @@
+#ifndef RENDER_PROFILE_H
+#define RENDER_PROFILE_H
+
+// Per-layer draw timing. Define PROFILE_RENDER in config.h to enable it, and
+// include this header after config.h so the calls compile away otherwise.
+// Wrapped layers have their update_proc swapped for a trampoline that times
+// the original with the DWT cycle counter.
+
+typedef enum {
+	RENDER_PROBE_FRAME = 0,		// window background; starts a new frame
+	RENDER_PROBE_TIME,
+	RENDER_PROBE_DATE,
+	RENDER_PROBE_REGIONS,		// weather region backgrounds
+	RENDER_PROBE_TEMPERATURE,
+	RENDER_PROBE_NOTIFICATION_COUNT,	// all sources together
+	RENDER_PROBE_ACTIVATION_CODE,
+	RENDER_PROBE_NOTIFICATION_ICON,
+	RENDER_PROBE_NO_LINK_ICON,
+	RENDER_PROBE_WEATHER_ICON,
+	RENDER_PROBE_COUNT
+} RenderProbe;
+
+// Frames kept for the percentiles, and layers that can be wrapped at once
+#define RENDER_PROFILE_FRAMES 32
+#define RENDER_PROFILE_LAYERS 16
+
+#if defined(PROFILE_RENDER) && !defined(PERF_COUNTERS)
+#error "PROFILE_RENDER needs PERF_COUNTERS"
+#endif
+
+#ifdef PROFILE_RENDER
+
+// Safe to call again after the SDK resets the layer's update_proc, as
+// bmp_init_container does.
+void render_profile_wrap(Layer* layer, RenderProbe probe);
+
+// Call once a minute. Logs p50/p99 cycles per probe over the last
+// RENDER_PROFILE_FRAMES frames and the frames drawn this minute when DEBUG
+// is defined.
+void render_profile_minute();
+
+#else
+
+#define render_profile_wrap(layer, probe)
+#define render_profile_minute()
+
+#endif // PROFILE_RENDER
+
+#endif // RENDER_PROFILE_H
@@ -0,0 +1,172 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "http.h"
+#include "http_keys.h"
+#include "protocol.h"
+#include "weather_layer.h"
+#include "warm_start.h"
+#include "replay.h"
+#include "config.h"
+#include "perf.h"
+
+#ifdef PERF_REPLAY
+
+#define REPLAY_ITERATIONS 500
+#define REPLAY_BUFFER_SIZE PROTOCOL_INBOUND_SIZE
+
+typedef enum {
+	REPLAY_HTTP_RESPONSE = 0,
+	REPLAY_RECONNECT,
+	REPLAY_TIME,
+	REPLAY_LOCATION,
+	REPLAY_COOKIE_GET,
+	REPLAY_COOKIE_SET,
+	REPLAY_COOKIE_DELETE,
+	REPLAY_COOKIE_FSYNC,
+	REPLAY_FOREIGN_APP,
+	REPLAY_TYPE_COUNT
+} ReplayType;
+
+static const char* REPLAY_TYPE_NAMES[REPLAY_TYPE_COUNT] = {
+	"http_response",
+	"reconnect",
+	"time",
+	"location",
+	"cookie_get",
+	"cookie_set",
+	"cookie_delete",
+	"cookie_fsync",
+	"foreign_app",
+};
+
+static uint8_t buffers[REPLAY_TYPE_COUNT][REPLAY_BUFFER_SIZE];
+static uint16_t sizes[REPLAY_TYPE_COUNT];
+static uint32_t delivered;
+
+static uint32_t float_bits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static uint16_t record(ReplayType type, int32_t app_id, uint8_t* buffer) {
+	const WarmStartRecord warm_start = {
+		.version = WARM_START_VERSION,
+		.icon = WEATHER_ICON_RAIN,
+		.temperature = 21,
+		.unread = { [NOTIFICATION_EMAIL] = 4, [NOTIFICATION_FACEBOOK] = 1 },
+		.saved_at = 1381000000
+	};
+	DictionaryIterator iter;
+	dict_write_begin(&iter, buffer, REPLAY_BUFFER_SIZE);
+	switch (type) {
+	case REPLAY_HTTP_RESPONSE:
+		dict_write_uint8(&iter, HTTP_URL_KEY, 1);
+		dict_write_int16(&iter, HTTP_STATUS_KEY, 200);
+		dict_write_int32(&iter, HTTP_COOKIE_KEY, WEATHER_HTTP_COOKIE);
+		dict_write_int32(&iter, HTTP_APP_ID_KEY, app_id);
+		dict_write_int8(&iter, WEATHER_KEY_ICON, WEATHER_ICON_RAIN);
+		dict_write_int16(&iter, WEATHER_KEY_TEMPERATURE, 21);
+		dict_write_int16(&iter, EMAIL_KEY_UNREAD, 4);
+		dict_write_int16(&iter, SEND_VIBRATE, 0);
+		dict_write_int16(&iter, UNREAD_FACEBOOK_MESSAGES, 1);
+		dict_write_int16(&iter, CHECKDIGITS, 1234);
+		break;
+	case REPLAY_RECONNECT:
+		dict_write_uint8(&iter, HTTP_CONNECT_KEY, 1);
+		break;
+	case REPLAY_TIME:
+		dict_write_uint32(&iter, HTTP_TIME_KEY, 1381000000);
+		dict_write_int32(&iter, HTTP_UTC_OFFSET_KEY, -18000);
+		dict_write_uint8(&iter, HTTP_IS_DST_KEY, 1);
+		dict_write_cstring(&iter, HTTP_TZ_NAME_KEY, "America/New_York");
+		break;
+	case REPLAY_LOCATION:
+		dict_write_uint32(&iter, HTTP_LOCATION_KEY, float_bits(25.f));
+		dict_write_uint32(&iter, HTTP_LATITUDE_KEY, float_bits(40.7128f));
+		dict_write_uint32(&iter, HTTP_LONGITUDE_KEY, float_bits(-74.006f));
+		dict_write_uint32(&iter, HTTP_ALTITUDE_KEY, float_bits(10.f));
+		break;
+	case REPLAY_COOKIE_GET:
+		dict_write_int32(&iter, HTTP_COOKIE_LOAD_KEY, WARM_START_REQUEST_ID);
+		dict_write_int32(&iter, HTTP_APP_ID_KEY, app_id);
+		dict_write_data(&iter, WARM_START_COOKIE_KEY, (const uint8_t*)&warm_start, sizeof(warm_start));
+		break;
+	case REPLAY_COOKIE_SET:
+		dict_write_int32(&iter, HTTP_COOKIE_STORE_KEY, WARM_START_REQUEST_ID);
+		dict_write_int32(&iter, HTTP_APP_ID_KEY, app_id);
+		break;
+	case REPLAY_COOKIE_DELETE:
+		dict_write_int32(&iter, HTTP_COOKIE_DELETE_KEY, WARM_START_REQUEST_ID);
+		dict_write_int32(&iter, HTTP_APP_ID_KEY, app_id);
+		break;
+	case REPLAY_COOKIE_FSYNC:
+		dict_write_uint8(&iter, HTTP_COOKIE_FSYNC_KEY, 1);
+		dict_write_int32(&iter, HTTP_APP_ID_KEY, app_id);
+		break;
+	case REPLAY_FOREIGN_APP:
+		dict_write_uint8(&iter, HTTP_URL_KEY, 1);
+		dict_write_int16(&iter, HTTP_STATUS_KEY, 200);
+		dict_write_int32(&iter, HTTP_COOKIE_KEY, WEATHER_HTTP_COOKIE);
+		dict_write_int32(&iter, HTTP_APP_ID_KEY, app_id + 1);
+		break;
+	default:
+		break;
+	}
+	return dict_write_end(&iter);
+}
+
+// Counting callbacks so the replay measures dispatch, not the UI behind it.
+static void replay_failure(int32_t request_id, int http_status, void* context) { delivered++; }
+static void replay_success(int32_t request_id, int http_status, DictionaryIterator* sent, void* context) { delivered++; }
+static void replay_reconnect(void* context) { delivered++; }
+static void replay_cookie_get(int32_t request_id, Tuple* result, void* context) { delivered++; }
+static void replay_cookie_set(int32_t request_id, bool successful, void* context) { delivered++; }
+static void replay_cookie_fsync(bool successful, void* context) { delivered++; }
+static void replay_cookie_delete(int32_t request_id, bool success, void* context) { delivered++; }
+static void replay_time(int32_t utc_offset_seconds, bool is_dst, uint32_t unixtime, const char* tz_name, void* context) { delivered++; }
+static void replay_location(float latitude, float longitude, float altitude, float accuracy, void* context) { delivered++; }
+
+void replay_run(int32_t app_id, void* context) {
+	http_set_app_id(app_id);
+	http_register_callbacks((HTTPCallbacks){
+		.failure = replay_failure,
+		.success = replay_success,
+		.reconnect = replay_reconnect,
+		.cookie_get = replay_cookie_get,
+		.cookie_set = replay_cookie_set,
+		.cookie_fsync = replay_cookie_fsync,
+		.cookie_delete = replay_cookie_delete,
+		.time = replay_time,
+		.location = replay_location
+	}, context);
+
+	for (int type = 0; type < REPLAY_TYPE_COUNT; type++) {
+		sizes[type] = record(type, app_id, buffers[type]);
+	}
+
+	perf_cycles_init();
+	uint32_t total_cycles = 0;
+	for (int type = 0; type < REPLAY_TYPE_COUNT; type++) {
+		DictionaryIterator iter;
+		uint32_t allocs = perf_counters[PERF_HEAP_ALLOC];
+		delivered = 0;
+
+		uint32_t start = perf_cycles();
+		for (int i = 0; i < REPLAY_ITERATIONS; i++) {
+			dict_read_begin_from_buffer(&iter, buffers[type], sizes[type]);
+			http_replay_received(&iter, context);
+		}
+		uint32_t cycles = perf_cycles() - start;
+		total_cycles += cycles;
+
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "replay %s bytes=%u cycles/msg=%lu delivered=%lu allocs=%lu",
+			REPLAY_TYPE_NAMES[type], sizes[type], cycles / REPLAY_ITERATIONS,
+			delivered, perf_counters[PERF_HEAP_ALLOC] - allocs);
+	}
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "replay total msgs=%lu cycles/msg=%lu",
+		(uint32_t)REPLAY_TYPE_COUNT * REPLAY_ITERATIONS,
+		total_cycles / (REPLAY_TYPE_COUNT * REPLAY_ITERATIONS));
+}
+
+#endif // PERF_REPLAY
@@ -0,0 +1,11 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Replays a recorded message of every inbound type http.c handles through
+// http_replay_received and logs cycles per message, deliveries and heap
+// allocations per type. Registers its own counting callbacks, so call it
+// before registering the real ones. Only built with PERF_REPLAY; on the host
+// build, make -C host run DEFINES=-DPERF_REPLAY.
+void replay_run(int32_t app_id, void* context);
+
+#endif // REPLAY_H
@@ -0,0 +1,119 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "weather_layer.h"
+#include "temperature_text.h"
+#include "status_board.h"
+
+static int16_t load_int16(const uint8_t* data) {
+	return (int16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t load_uint32(const uint8_t* data) {
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void status_board_decode_packed(const uint8_t* data, uint16_t length, StatusBoardUpdate* update) {
+	// Unknown versions are ignored so a newer bridge can't corrupt the screen
+	if (length < STATUS_BOARD_PACKED_SIZE || data[PACKED_OFFSET_VERSION] != STATUS_BOARD_PACKED_VERSION) {
+		return;
+	}
+	uint8_t present = data[PACKED_OFFSET_PRESENT] &
+		~(STATUS_BOARD_HAS_ACTIVATION_CODE | STATUS_BOARD_HAS_CHECKDIGITS);
+	update->present |= present;
+	update->icon = (int8_t)data[PACKED_OFFSET_ICON];
+	update->temperature = load_int16(&data[PACKED_OFFSET_TEMPERATURE]);
+	update->unread_email = load_int16(&data[PACKED_OFFSET_UNREAD_EMAIL]);
+	update->unread_facebook = load_int16(&data[PACKED_OFFSET_UNREAD_FACEBOOK]);
+	update->vibrate = data[PACKED_OFFSET_VIBRATE];
+	update->version = load_uint32(&data[PACKED_OFFSET_PAYLOAD_VERSION]);
+}
+
+// Integers may arrive narrower or wider than the schema says
+static int32_t tuple_int(const Tuple* tuple) {
+	switch (tuple->length) {
+	case 1: return tuple->type == TUPLE_INT ? tuple->value->int8 : tuple->value->uint8;
+	case 2: return tuple->type == TUPLE_INT ? tuple->value->int16 : tuple->value->uint16;
+	default: return tuple->value->int32;
+	}
+}
+
+static void copy_cstring(char* dest, uint16_t size, const Tuple* tuple) {
+	uint16_t length = tuple->length;
+	if (length > size - 1) {
+		length = size - 1;
+	}
+	memcpy(dest, tuple->value->cstring, length);
+	dest[length] = '\0';
+}
+
+#define ENCODE_INT(constant, member, width) dict_write_int(body, constant, &request->member, width, true)
+#define ENCODE_UINT(constant, member, width) dict_write_int(body, constant, &request->member, width, false)
+#define ENCODE_NONCE(constant, member, width) DICT_OK
+#define ENCODE_FIELD(constant, key, member, kind, width) \
+	if (result == DICT_OK) result = ENCODE_##kind(constant, member, width);
+
+DictionaryResult status_board_encode(DictionaryIterator* body, const StatusBoardRequest* request) {
+	DictionaryResult result = DICT_OK;
+	STATUS_BOARD_REQUEST_FIELDS(ENCODE_FIELD)
+	return result;
+}
+
+#define DECODE_INT(member, width) update->member = tuple_int(tuple);
+#define DECODE_UINT(member, width) update->member = tuple_int(tuple);
+#define DECODE_NONCE(member, width) update->member = tuple_int(tuple);
+#define DECODE_CSTRING(member, width) copy_cstring(update->member, width, tuple);
+#define DECODE_PACKED(member, width) status_board_decode_packed(tuple->value->data, tuple->length, update);
+#define DECODE_FIELD(constant, key, member, kind, width, flag) \
+	case constant: \
+		DECODE_##kind(member, width) \
+		update->present |= flag; \
+		break;
+
+void status_board_decode(DictionaryIterator* received, StatusBoardUpdate* update) {
+	memset(update, 0, sizeof(StatusBoardUpdate));
+
+	for (Tuple* tuple = dict_read_first(received); tuple; tuple = dict_read_next(received)) {
+		switch (tuple->key) {
+		STATUS_BOARD_RESPONSE_FIELDS(DECODE_FIELD)
+		default:
+			break;
+		}
+	}
+}
+
+#define GET_INT(member) *value = update->member; return true;
+#define GET_UINT(member) *value = update->member; return true;
+#define GET_NONCE(member) *value = update->member; return true;
+#define GET_CSTRING(member) return false;
+#define GET_PACKED(member) return false;
+#define GET_FIELD(constant, key, member, kind, width, flag) \
+	case constant: \
+		if (!(update->present & flag)) return false; \
+		GET_##kind(member)
+
+bool status_board_get_int(const StatusBoardUpdate* update, uint32_t key, int32_t* value) {
+	switch (key) {
+	STATUS_BOARD_RESPONSE_FIELDS(GET_FIELD)
+	default:
+		return false;
+	}
+}
+
+bool status_board_validate(StatusBoardUpdate* update) {
+	if (!(update->present & STATUS_BOARD_HAS_CHECKDIGITS)) {
+		return false;
+	}
+	if (!update->not_modified) {
+		update->present &= ~STATUS_BOARD_NOT_MODIFIED;
+	}
+	// The bridge never sends the no-weather icon; anything past it is junk.
+	if (update->icon < 0 || update->icon >= WEATHER_ICON_NO_WEATHER) {
+		update->present &= ~STATUS_BOARD_HAS_ICON;
+	}
+	// Nothing on Earth reads outside the text table, and the panel has no
+	// room for the digits if something claims to
+	if (update->temperature < TEMPERATURE_TEXT_MIN || update->temperature > TEMPERATURE_TEXT_MAX) {
+		update->present &= ~STATUS_BOARD_HAS_TEMPERATURE;
+	}
+	return true;
+}
@@ -0,0 +1,34 @@
+#ifndef STATUS_BOARD_H
+#define STATUS_BOARD_H
+
+#include "protocol.h"
+
+// Packed response: one byte array under STATUS_BOARD_PACKED replacing the
+// individual field tuples. CHECKDIGITS stays a tuple of its own so http.c
+// can match the response, and activation codes keep the tuple format.
+// Multi-byte values are little endian.
+#define STATUS_BOARD_PACKED_VERSION 1
+#define PACKED_OFFSET_VERSION 0
+#define PACKED_OFFSET_PRESENT 1		// low byte of StatusBoardField
+#define PACKED_OFFSET_ICON 2
+#define PACKED_OFFSET_TEMPERATURE 3
+#define PACKED_OFFSET_UNREAD_EMAIL 5
+#define PACKED_OFFSET_UNREAD_FACEBOOK 7
+#define PACKED_OFFSET_VIBRATE 9
+#define PACKED_OFFSET_PAYLOAD_VERSION 10
+
+// Writes every request field except the nonce, which http.c adds itself
+DictionaryResult status_board_encode(DictionaryIterator* body, const StatusBoardRequest* request);
+
+void status_board_decode(DictionaryIterator* received, StatusBoardUpdate* update);
+
+// Returns false if the response carries no check digits. http.c has already
+// matched them to a pending request. Also drops fields whose values are out
+// of range, and a NOT_MODIFIED sent as zero.
+bool status_board_validate(StatusBoardUpdate* update);
+
+// Looks up an integer response field by key, for callers that hold keys in a
+// table. Returns false if the field is absent or not an integer.
+bool status_board_get_int(const StatusBoardUpdate* update, uint32_t key, int32_t* value);
+
+#endif // STATUS_BOARD_H
@@ -0,0 +1,43 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "temperature_text.h"
+
+// The whole table is spelled out by the preprocessor, starting at -99.
+// Everything uses the small font; 10-19 sit slightly left because of the
+// narrow 1.
+#define DEGREE "°"
+#define CENTER(n) { #n DEGREE, FONT_FUTURA_18, GTextAlignmentCenter }
+#define LEFT(n) { #n DEGREE, FONT_FUTURA_18, GTextAlignmentLeft }
+#define BELOW(n) { "-" #n DEGREE, FONT_FUTURA_18, GTextAlignmentCenter }
+
+#define DIGITS(X, p) X(p##0), X(p##1), X(p##2), X(p##3), X(p##4), X(p##5), X(p##6), X(p##7), X(p##8), X(p##9)
+#define DIGITS_DOWN(X, p) X(p##9), X(p##8), X(p##7), X(p##6), X(p##5), X(p##4), X(p##3), X(p##2), X(p##1), X(p##0)
+#define HUNDRED(X, p) DIGITS(X, p##0), DIGITS(X, p##1), DIGITS(X, p##2), DIGITS(X, p##3), DIGITS(X, p##4), \
+	DIGITS(X, p##5), DIGITS(X, p##6), DIGITS(X, p##7), DIGITS(X, p##8), DIGITS(X, p##9)
+
+static const TemperatureText TEMPERATURE_TEXT[] = {
+	// -99 to -10
+	DIGITS_DOWN(BELOW, 9), DIGITS_DOWN(BELOW, 8), DIGITS_DOWN(BELOW, 7), DIGITS_DOWN(BELOW, 6),
+	DIGITS_DOWN(BELOW, 5), DIGITS_DOWN(BELOW, 4), DIGITS_DOWN(BELOW, 3), DIGITS_DOWN(BELOW, 2),
+	DIGITS_DOWN(BELOW, 1),
+	// -9 to -1
+	BELOW(9), BELOW(8), BELOW(7), BELOW(6), BELOW(5), BELOW(4), BELOW(3), BELOW(2), BELOW(1),
+	// 0 to 99
+	CENTER(0), CENTER(1), CENTER(2), CENTER(3), CENTER(4),
+	CENTER(5), CENTER(6), CENTER(7), CENTER(8), CENTER(9),
+	DIGITS(LEFT, 1),
+	DIGITS(CENTER, 2), DIGITS(CENTER, 3), DIGITS(CENTER, 4), DIGITS(CENTER, 5),
+	DIGITS(CENTER, 6), DIGITS(CENTER, 7), DIGITS(CENTER, 8), DIGITS(CENTER, 9),
+	// 100 to 199
+	HUNDRED(CENTER, 1),
+};
+
+typedef char temperature_text_complete[
+	sizeof(TEMPERATURE_TEXT) / sizeof(TEMPERATURE_TEXT[0]) == TEMPERATURE_TEXT_MAX - TEMPERATURE_TEXT_MIN + 1 ? 1 : -1];
+
+const TemperatureText* temperature_text_lookup(int16_t t) {
+	if (t < TEMPERATURE_TEXT_MIN || t > TEMPERATURE_TEXT_MAX) {
+		return NULL;
+	}
+	return &TEMPERATURE_TEXT[t - TEMPERATURE_TEXT_MIN];
+}
@@ -0,0 +1,20 @@
+#ifndef TEMPERATURE_TEXT_H
+#define TEMPERATURE_TEXT_H
+
+#include "font_registry.h"
+
+#define TEMPERATURE_TEXT_MIN -99
+#define TEMPERATURE_TEXT_MAX 199
+
+// A temperature ready to display: the text with its degree sign, and the
+// font and alignment to show it in.
+typedef struct {
+	char text[6];
+	uint8_t font;		// FontSlot
+	uint8_t alignment;	// GTextAlignment
+} TemperatureText;
+
+// Returns NULL outside TEMPERATURE_TEXT_MIN..TEMPERATURE_TEXT_MAX
+const TemperatureText* temperature_text_lookup(int16_t t);
+
+#endif // TEMPERATURE_TEXT_H
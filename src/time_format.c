@@ -0,0 +1,46 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "time_format.h"
+
+#define TENS(t) ":" #t "0", ":" #t "1", ":" #t "2", ":" #t "3", ":" #t "4", \
+	":" #t "5", ":" #t "6", ":" #t "7", ":" #t "8", ":" #t "9"
+
+// Also the source of the two-digit day of the month
+static const char MINUTES[60][4] = {
+	TENS(0), TENS(1), TENS(2), TENS(3), TENS(4), TENS(5)
+};
+
+static const char HOURS_24[24][3] = {
+	"0", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11",
+	"12", "13", "14", "15", "16", "17", "18", "19", "20", "21", "22", "23"
+};
+
+static const char HOURS_12[24][3] = {
+	"12", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11",
+	"12", "1", "2", "3", "4", "5", "6", "7", "8", "9", "10", "11"
+};
+
+static const char WEEKDAYS[7][4] = {
+	"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+};
+
+static const char MONTHS[12][4] = {
+	"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+	"Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+const char* time_format_hour(const PblTm* time, bool is_24h) {
+	return is_24h ? HOURS_24[time->tm_hour] : HOURS_12[time->tm_hour];
+}
+
+const char* time_format_minute(const PblTm* time) {
+	return MINUTES[time->tm_min];
+}
+
+const char* time_format_date(const PblTm* time) {
+	static char date[] = "XXX, XXX 00";
+	memcpy(&date[0], WEEKDAYS[time->tm_wday], 3);
+	memcpy(&date[5], MONTHS[time->tm_mon], 3);
+	memcpy(&date[9], &MINUTES[time->tm_mday][1], 2);
+	return date;
+}
@@ -0,0 +1,15 @@
+#ifndef TIME_FORMAT_H
+#define TIME_FORMAT_H
+
+// Clock strings served from static tables. Every call for the same hour or
+// minute returns the same pointer, so callers can tell text apart by pointer.
+
+// "7", "19" or "12"; no leading zero
+const char* time_format_hour(const PblTm* time, bool is_24h);
+// ":05"
+const char* time_format_minute(const PblTm* time);
+// "Mon, Jan 05". Rebuilt in a static buffer on each call, so only call it
+// when the day changes.
+const char* time_format_date(const PblTm* time);
+
+#endif // TIME_FORMAT_H
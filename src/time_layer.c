@@ -1,4 +1,41 @@
 #include "time_layer.h"
+#include "config.h"
+#include "perf.h"
+
+/* Measure both strings and split the layer bounds between them. The result
+* is kept until the text, fonts or bounds change.
+*/
+static void time_layer_update_layout(TimeLayer *tl, GContext* ctx)
+{
+    GSize hour_sz =
+        graphics_text_layout_get_max_used_size(ctx,
+                                               tl->hour_text,
+                                               tl->hour_font,
+                                               tl->layer.bounds,
+                                               tl->overflow_mode,
+                                               GTextAlignmentLeft,
+                                               tl->layout_cache);
+    GSize minute_sz =
+        graphics_text_layout_get_max_used_size(ctx,
+                                               tl->minute_text,
+                                               tl->minute_font,
+                                               tl->layer.bounds,
+                                               tl->overflow_mode,
+                                               GTextAlignmentLeft,
+                                               tl->layout_cache);
+    int width = minute_sz.w + hour_sz.w;
+    int half = tl->layer.bounds.size.w / 2;
+
+    tl->hour_bounds = tl->layer.bounds;
+    tl->minute_bounds = tl->layer.bounds;
+    tl->hour_bounds.size.w = half - (width / 2) + hour_sz.w;
+    tl->minute_bounds.origin.x = tl->hour_bounds.size.w + 1;
+    tl->minute_bounds.size.w = minute_sz.w;
+
+    tl->layout_bounds = tl->layer.bounds;
+    tl->layout_valid = true;
+}
+
 
 /* Called by the graphics layers when the time layer needs to be updated.
 */
@@ -13,42 +50,22 @@ void time_layer_update_proc(TimeLayer *tl, GContext* ctx)
 
     if (tl->hour_text && tl->minute_text)
     {
-        GSize hour_sz =
-            graphics_text_layout_get_max_used_size(ctx,
-                                                   tl->hour_text,
-                                                   tl->hour_font,
-                                                   tl->layer.bounds,
-                                                   tl->overflow_mode,
-                                                   GTextAlignmentLeft,
-                                                   tl->layout_cache);
-        GSize minute_sz =
-            graphics_text_layout_get_max_used_size(ctx,
-                                                   tl->minute_text,
-                                                   tl->minute_font,
-                                                   tl->layer.bounds,
-                                                   tl->overflow_mode,
-                                                   GTextAlignmentLeft,
-                                                   tl->layout_cache);
-        int width = minute_sz.w + hour_sz.w;
-        int half = tl->layer.bounds.size.w / 2;
-        GRect hour_bounds = tl->layer.bounds;
-        GRect minute_bounds = tl->layer.bounds;
-
-        hour_bounds.size.w = half - (width / 2) + hour_sz.w;
-        minute_bounds.origin.x = hour_bounds.size.w + 1;
-        minute_bounds.size.w = minute_sz.w;
+        if (!tl->layout_valid || !grect_equal(&tl->layout_bounds, &tl->layer.bounds))
+        {
+            time_layer_update_layout(tl, ctx);
+        }
 
         graphics_text_draw(ctx,
                            tl->hour_text,
                            tl->hour_font,
-                           hour_bounds,
+                           tl->hour_bounds,
                            tl->overflow_mode,
                            GTextAlignmentRight,
                            tl->layout_cache);
         graphics_text_draw(ctx,
                            tl->minute_text,
                            tl->minute_font,
-                           minute_bounds,
+                           tl->minute_bounds,
                            tl->overflow_mode,
                            GTextAlignmentLeft,
                            tl->layout_cache);
@@ -56,14 +73,21 @@ void time_layer_update_proc(TimeLayer *tl, GContext* ctx)
 }
 
 
-/* Set the hour and minute text and mark the layer dirty. NOTE that the
-* two strings must be static because we're only storing a pointer to them,
-* not making a copy.
+/* Set the hour and minute text and mark the layer dirty if either pointer
+* changed since the last call. NOTE that the two strings must be static
+* and must not be modified afterwards: new text has to come in through a
+* different pointer, as the time_format tables do.
 */
-void time_layer_set_text(TimeLayer *tl, char *hour_text, char *minute_text)
+void time_layer_set_text(TimeLayer *tl, const char *hour_text, const char *minute_text)
 {
+    if (tl->hour_text == hour_text && tl->minute_text == minute_text)
+    {
+        return;
+    }
+
     tl->hour_text = hour_text;
     tl->minute_text = minute_text;
+    tl->layout_valid = false;
 
     layer_mark_dirty(&(tl->layer));
 }
@@ -73,6 +97,12 @@ void time_layer_set_text(TimeLayer *tl, char *hour_text, char *minute_text)
 */
 void time_layer_set_fonts(TimeLayer *tl, GFont hour_font, GFont minute_font)
 {
+    if (tl->hour_font == hour_font && tl->minute_font == minute_font)
+    {
+        return;
+    }
+
+    tl->layout_valid = false;
     tl->hour_font = hour_font;
     tl->minute_font = minute_font;
 
@@ -118,6 +148,9 @@ void time_layer_init(TimeLayer *tl, GRect frame)
     tl->text_color = GColorWhite;
     tl->background_color = GColorClear;
     tl->overflow_mode = GTextOverflowModeWordWrap;
+    tl->hour_text = NULL;
+    tl->minute_text = NULL;
+    tl->layout_valid = false;
 
     tl->hour_font = fonts_get_system_font(FONT_KEY_GOTHIC_14_BOLD);
     tl->minute_font = tl->hour_font;
@@ -13,13 +13,20 @@ typedef struct _TimeLayer
     GFont hour_font;
     GFont minute_font;
     GTextLayoutCacheRef layout_cache;
+    /* Memoized layout. Only recomputed when the text, the fonts or the
+    * layer bounds change.
+    */
+    GRect layout_bounds;
+    GRect hour_bounds;
+    GRect minute_bounds;
+    bool layout_valid;
     GColor text_color : 2;
     GColor background_color : 2;
     GTextOverflowMode overflow_mode : 2;
 } TimeLayer;
 
 void time_layer_update_proc(TimeLayer *tl, GContext* ctx);
-void time_layer_set_text(TimeLayer *tl, char *hour_text, char *minute_text);
+void time_layer_set_text(TimeLayer *tl, const char *hour_text, const char *minute_text);
 void time_layer_set_fonts(TimeLayer *tl, GFont hour_font, GFont minute_font);
 void time_layer_set_text_color(TimeLayer *tl, GColor color);
 void time_layer_set_background_color(TimeLayer *tl, GColor color);
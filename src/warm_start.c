@@ -0,0 +1,67 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "http.h"
+#include "weather_layer.h"
+#include "temperature_text.h"
+#include "warm_start.h"
+
+// Each notification source adds two bytes to the record
+typedef char warm_start_record_size[sizeof(WarmStartRecord) == 8 + 2 * NOTIFICATION_SOURCE_COUNT &&
+	sizeof(WarmStartRecord) <= HTTP_QUEUE_VALUE_MAX ? 1 : -1];
+// Data the bridge keeps confirming must be rewritten before it reads as stale
+typedef char warm_start_save_interval[WARM_START_SAVE_INTERVAL_SECONDS < WARM_START_STALE_SECONDS ? 1 : -1];
+
+void warm_start_request() {
+	http_cookie_get(WARM_START_REQUEST_ID, WARM_START_COOKIE_KEY);
+}
+
+static WarmStartRecord last_saved;
+static uint32_t last_write = 0;
+
+bool warm_start_save(const WeatherLayerState* state, uint32_t confirmed_at) {
+	if (!confirmed_at || !state->has_temperature || state->has_activation_code) return false;
+	// A change made inside the interval waits for it to end
+	uint32_t now = time(NULL);
+	if (last_write && now - last_write < WARM_START_SAVE_INTERVAL_SECONDS) return false;
+	
+	WarmStartRecord record = {
+		.version = WARM_START_VERSION,
+		.icon = state->has_icon ? (int8_t)state->icon : -1,
+		.temperature = state->temperature,
+		.saved_at = confirmed_at
+	};
+	for (int i = 0; i < NOTIFICATION_SOURCE_COUNT; i++) {
+		record.unread[i] = (state->has_unread & (1 << i)) ? state->unread[i] : -1;
+	}
+	// The record is packed, so equal fields mean equal bytes: nothing new
+	// arrived since the last write, e.g. while the phone is out of reach
+	if (memcmp(&record, &last_saved, sizeof(record)) == 0) return false;
+	
+	http_cookie_set_data(WARM_START_REQUEST_ID, WARM_START_COOKIE_KEY, (const uint8_t*)&record, sizeof(record));
+	last_saved = record;
+	last_write = now;
+	return true;
+}
+
+bool warm_start_decode(int32_t request_id, Tuple* tuple, WeatherLayerState* state) {
+	WarmStartRecord record;
+	if (request_id != WARM_START_REQUEST_ID || tuple->key != WARM_START_COOKIE_KEY ||
+		tuple->length != (uint16_t)sizeof(record)) {
+		return false;
+	}
+	memcpy(&record, tuple->value->data, sizeof(record));
+	if (record.version != WARM_START_VERSION) return false;
+	if (record.temperature < TEMPERATURE_TEXT_MIN || record.temperature > TEMPERATURE_TEXT_MAX) return false;
+
+	bool stale = (uint32_t)time(NULL) - record.saved_at > WARM_START_STALE_SECONDS;
+	state->has_icon = !stale && record.icon >= 0 && record.icon < WEATHER_ICON_NO_WEATHER;
+	state->icon = state->has_icon ? record.icon : 0;
+	state->has_temperature = true;
+	state->temperature = record.temperature;
+	state->has_unread = 0;
+	for (int i = 0; i < NOTIFICATION_SOURCE_COUNT; i++) {
+		if (record.unread[i] >= 0) state->has_unread |= 1 << i;
+		state->unread[i] = record.unread[i];
+	}
+	return true;
+}
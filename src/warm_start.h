@@ -0,0 +1,42 @@
+#ifndef WARM_START_H
+#define WARM_START_H
+
+// The last applied status board, kept in the bridge's cookie store so a fresh
+// launch can paint it before the location and data round trips finish.
+#define WARM_START_REQUEST_ID 1949327680
+#define WARM_START_COOKIE_KEY 1
+#define WARM_START_VERSION 2
+// Records confirmed longer ago than this are still shown, but without the
+// weather icon.
+#define WARM_START_STALE_SECONDS (30 * 60)
+
+typedef struct __attribute__((__packed__)) {
+	uint8_t version;
+	int8_t icon;
+	int16_t temperature;
+	int16_t unread[NOTIFICATION_SOURCE_COUNT];	// -1 when absent
+	uint32_t saved_at;
+} WarmStartRecord;
+
+// Queues the cookie read. The record arrives through the cookie_get callback.
+void warm_start_request();
+
+// Saves are throttled to keep the radio quiet: writes are at least this far
+// apart, so a change made sooner after the last write reaches the cookie
+// store only when the interval ends. Each write stamps saved_at with the
+// latest confirmation, so while the bridge keeps answering a record is never
+// more than an interval and a poll old.
+#define WARM_START_SAVE_INTERVAL_SECONDS (25 * 60)
+
+// Stores the parts of state that can be shown on the next launch, unless
+// the throttle holds it back. confirmed_at is when the bridge last vouched
+// for state, a response or a not-modified reply, and becomes the record's
+// saved_at; 0 means it never has and nothing is saved. Cheap enough to call
+// every minute. Returns true if a cookie write was queued.
+bool warm_start_save(const WeatherLayerState* state, uint32_t confirmed_at);
+
+// Turns a cookie_get tuple into a state to apply. Returns false if the tuple
+// is not a warm start record.
+bool warm_start_decode(int32_t request_id, Tuple* tuple, WeatherLayerState* state);
+
+#endif // WARM_START_H
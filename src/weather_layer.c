@@ -2,234 +2,438 @@
 #include "pebble_app.h"
 #include "pebble_fonts.h"
 #include "util.h"
+#include "font_registry.h"
+#include "temperature_text.h"
 #include "weather_layer.h"
+#include "config.h"
+#include "perf.h"
+#include "render_profile.h"
 
-static uint8_t WEATHER_ICONS[] = {
-	RESOURCE_ID_ICON_CLEAR_DAY,
-	RESOURCE_ID_ICON_CLEAR_NIGHT,
-	RESOURCE_ID_ICON_RAIN,
-	RESOURCE_ID_ICON_SNOW,
-	RESOURCE_ID_ICON_SLEET,
-	RESOURCE_ID_ICON_WIND,
-	RESOURCE_ID_ICON_FOG,
-	RESOURCE_ID_ICON_CLOUDY,
-	RESOURCE_ID_ICON_PARTLY_CLOUDY_DAY,
-	RESOURCE_ID_ICON_PARTLY_CLOUDY_NIGHT,
-	RESOURCE_ID_ICON_ERROR,
+static const AtlasIcon WEATHER_ICONS[WEATHER_ICON_COUNT] = {
+	ATLAS_ICON_CLEAR_DAY,
+	ATLAS_ICON_CLEAR_NIGHT,
+	ATLAS_ICON_RAIN,
+	ATLAS_ICON_SNOW,
+	ATLAS_ICON_SLEET,
+	ATLAS_ICON_WIND,
+	ATLAS_ICON_FOG,
+	ATLAS_ICON_CLOUDY,
+	ATLAS_ICON_PARTLY_CLOUDY_DAY,
+	ATLAS_ICON_PARTLY_CLOUDY_NIGHT,
+	ATLAS_ICON_ERROR,
 };
 
+// With the notification rows stacked from (0, 10) down the left, the opaque
+// regions cover the white panel from (0, 10) to (144, 78)
+static const GRect WEATHER_REGION_FRAMES[WEATHER_REGION_COUNT] = {
+	[WEATHER_REGION_TEMPERATURE] = {{70, 10}, {74, 35}},
+	[WEATHER_REGION_ICON] = {{70, 45}, {74, 33}},
+	[WEATHER_REGION_ACTIVATION_CODE] = {{0, 10}, {110, 68}},
+};
+
+static void region_update_proc(Layer* layer, GContext* ctx) {
+	graphics_context_set_fill_color(ctx, GColorWhite);
+	graphics_fill_rect(ctx, layer->bounds, 0, GCornerNone);
+}
+
+// The notification column is 70px wide, but a row's Layer is 80px so the
+// 40px count can run into the temperature and icon column, as the original
+// text layers did. The row only paints its own column white, and is added
+// after those regions so the digits draw over them.
+#define NOTIFICATION_COLUMN_WIDTH 70
+#define NOTIFICATION_COUNT_WIDTH 40
+
+static void notification_region_update_proc(Layer* layer, GContext* ctx) {
+	graphics_context_set_fill_color(ctx, GColorWhite);
+	graphics_fill_rect(ctx, GRect(0, 0, NOTIFICATION_COLUMN_WIDTH, layer->bounds.size.h), 0, GCornerNone);
+}
+
+// Where a row's icon and count start, from the top of its region
+static int16_t notification_content_top(int row) {
+	return NOTIFICATION_CONTENT_TOP + row * NOTIFICATION_CONTENT_PITCH - (10 + row * NOTIFICATION_ROW_HEIGHT);
+}
+
+static void invalidate_layer(Layer* layer) {
+	layer_mark_dirty(layer);
+	PERF_ADD(PERF_DIRTY_PIXELS, layer_get_frame(layer).size.w * layer_get_frame(layer).size.h);
+}
+
+static void invalidate_region(WeatherLayer* weather_layer, WeatherRegion region) {
+	invalidate_layer(&weather_layer->regions[region]);
+}
+
+static void invalidate_notifications(WeatherLayer* weather_layer) {
+	for (int i = 0; i < NOTIFICATION_SOURCE_COUNT; i++) {
+		invalidate_layer(&weather_layer->notifications[i].region);
+	}
+}
+
+static void notification_slot_init(WeatherLayer* weather_layer, NotificationSlot* slot, int row) {
+	int16_t top = notification_content_top(row);
+	layer_init(&slot->region, GRect(0, 10 + row * NOTIFICATION_ROW_HEIGHT,
+		40 + NOTIFICATION_COUNT_WIDTH, NOTIFICATION_ROW_HEIGHT));
+	slot->region.update_proc = notification_region_update_proc;
+	render_profile_wrap(&slot->region, RENDER_PROBE_REGIONS);
+	layer_add_child(&weather_layer->layer, &slot->region);
+	
+	text_layer_init(&slot->count_layer, GRect(40, top, NOTIFICATION_COUNT_WIDTH, NOTIFICATION_ROW_HEIGHT - top));
+	text_layer_set_background_color(&slot->count_layer, GColorClear);
+	text_layer_set_text_alignment(&slot->count_layer, GTextAlignmentLeft);
+	text_layer_set_font(&slot->count_layer, weather_layer->font_small);
+	layer_add_child(&slot->region, &slot->count_layer.layer);
+	render_profile_wrap(&slot->count_layer.layer, RENDER_PROBE_NOTIFICATION_COUNT);
+	slot->has_icon = false;
+}
+
 void weather_layer_init(WeatherLayer* weather_layer, GPoint pos) {
 	layer_init(&weather_layer->layer, GRect(pos.x, pos.y, 144, 80));
 	
-	// Add background layer
-	text_layer_init(&weather_layer->temp_layer_background, GRect(0, 10, 144, 68));
-	text_layer_set_background_color(&weather_layer->temp_layer_background, GColorWhite);
-	layer_add_child(&weather_layer->layer, &weather_layer->temp_layer_background.layer);
+	// Fonts are shared through the registry and released in weather_layer_deinit
+	weather_layer->font_small = font_registry_acquire(FONT_FUTURA_18);
+	weather_layer->font_medium = font_registry_acquire(FONT_FUTURA_35);
+	weather_layer->font_large = font_registry_acquire(FONT_FUTURA_40);
+	
+	for (int i = 0; i < WEATHER_REGION_COUNT; i++) {
+		// The slots go in after the temperature and icon, which their counts
+		// overlap, and before the activation code region, which draws over
+		// them
+		if (i == WEATHER_REGION_ACTIVATION_CODE) {
+			for (int j = 0; j < NOTIFICATION_SOURCE_COUNT; j++) {
+				notification_slot_init(weather_layer, &weather_layer->notifications[j], j);
+			}
+		}
+		layer_init(&weather_layer->regions[i], WEATHER_REGION_FRAMES[i]);
+		if (i != WEATHER_REGION_ACTIVATION_CODE) {
+			weather_layer->regions[i].update_proc = region_update_proc;
+			render_profile_wrap(&weather_layer->regions[i], RENDER_PROBE_REGIONS);
+		}
+		layer_add_child(&weather_layer->layer, &weather_layer->regions[i]);
+	}
 	
     // Add temperature layer
-	text_layer_init(&weather_layer->temp_layer, GRect(70, 19, 72, 80));
+	text_layer_init(&weather_layer->temp_layer, GRect(0, 9, 72, 26));
 	text_layer_set_background_color(&weather_layer->temp_layer, GColorClear);
 	text_layer_set_text_alignment(&weather_layer->temp_layer, GTextAlignmentCenter);
-	text_layer_set_font(&weather_layer->temp_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_40)));
-	layer_add_child(&weather_layer->layer, &weather_layer->temp_layer.layer);
-    
-    // Unread Email Messages Layer
-	text_layer_init(&weather_layer->messages_layer, GRect(40,19, 40, 40));
-	text_layer_set_background_color(&weather_layer->messages_layer, GColorClear);
-	text_layer_set_text_alignment(&weather_layer->messages_layer, GTextAlignmentCenter);
-	text_layer_set_font(&weather_layer->messages_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_35)));
-	layer_add_child(&weather_layer->layer, &weather_layer->messages_layer.layer);	
-
-    // Unread Facebook Messages/Notifications Layer
-	text_layer_init(&weather_layer->facebook_messages_layer, GRect(40, 50, 40, 40));
-	text_layer_set_background_color(&weather_layer->facebook_messages_layer, GColorClear);
-	text_layer_set_text_alignment(&weather_layer->facebook_messages_layer, GTextAlignmentCenter);
-	text_layer_set_font(&weather_layer->facebook_messages_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_35)));
-	layer_add_child(&weather_layer->layer, &weather_layer->facebook_messages_layer.layer);	
-
-
-    // Activation Code Layer
-	text_layer_init(&weather_layer->activation_code_layer, GRect(10, 10, 100, 100));
-	text_layer_set_background_color(&weather_layer->activation_code_layer, GColorClear);
-	text_layer_set_text_alignment(&weather_layer->activation_code_layer, GTextAlignmentCenter);
-	text_layer_set_font(&weather_layer->activation_code_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_35)));
+	text_layer_set_font(&weather_layer->temp_layer, weather_layer->font_large);
+	layer_add_child(&weather_layer->regions[WEATHER_REGION_TEMPERATURE], &weather_layer->temp_layer.layer);
+	render_profile_wrap(&weather_layer->temp_layer.layer, RENDER_PROBE_TEMPERATURE);
 
+	icon_atlas_init();
+	weather_layer->overlay = NULL;
 	weather_layer->has_weather_icon = false;
 	weather_layer->has_no_link_icon = false;
-	weather_layer->has_mail_icon = false;
-	weather_layer->has_facebook_icon = false;
 	weather_layer->has_activation_code = false;
-    weather_layer->unread_messages = 0;
+	memset(&weather_layer->state, 0, sizeof(WeatherLayerState));
+	weather_layer->temp_text = NULL;
+	weather_layer->redraws_avoided = 0;
+#ifdef DEBUG
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "per notification source: slot=%u state=%u bytes",
+		sizeof(NotificationSlot), sizeof(int16_t));
+#endif
 }
 
-void weather_layer_set_no_link_icon(WeatherLayer* weather_layer) {
-	
-	if (weather_layer->has_mail_icon) {
-		layer_remove_from_parent(&weather_layer->icon_layer.layer.layer);
-		bmp_deinit_container(&weather_layer->icon_layer);
-		weather_layer->has_mail_icon = false;
+static void hide_notification_icons(WeatherLayer* weather_layer) {
+	for (int i = 0; i < NOTIFICATION_SOURCE_COUNT; i++) {
+		NotificationSlot* slot = &weather_layer->notifications[i];
+		if (slot->has_icon) {
+			layer_remove_from_parent(&slot->icon.layer.layer);
+			slot->has_icon = false;
+			invalidate_layer(&slot->region);
+		}
 	}
-	
-	if (weather_layer->has_facebook_icon) {
-	   layer_remove_from_parent(&weather_layer->icon_layer2.layer.layer);
-	   bmp_deinit_container(&weather_layer->icon_layer2);
-	   weather_layer->has_facebook_icon = false;
+}
+
+static void hide_no_link_icon(WeatherLayer* weather_layer) {
+	if (weather_layer->has_no_link_icon) {
+		layer_remove_from_parent(&weather_layer->overlay->sprite.layer.layer);
+		layer_pool_release(weather_layer->overlay);
+		weather_layer->overlay = NULL;
+		weather_layer->has_no_link_icon = false;
+		invalidate_notifications(weather_layer);
 	}
-	
+}
+
+static void hide_activation_code(WeatherLayer* weather_layer) {
+	if (weather_layer->has_activation_code) {
+		layer_remove_from_parent(&weather_layer->overlay->text.layer);
+		layer_pool_release(weather_layer->overlay);
+		weather_layer->overlay = NULL;
+		weather_layer->has_activation_code = false;
+		invalidate_region(weather_layer, WEATHER_REGION_ACTIVATION_CODE);
+	}
+}
+
+static void show_no_link_icon(WeatherLayer* weather_layer) {
+	hide_notification_icons(weather_layer);
+	hide_activation_code(weather_layer);
 	
 	if (!weather_layer->has_no_link_icon) {
-  	  bmp_init_container(RESOURCE_ID_ICON_ERROR, &weather_layer->icon_layer);
-	  layer_add_child(&weather_layer->layer, &weather_layer->icon_layer.layer.layer);
-	  layer_set_frame(&weather_layer->icon_layer.layer.layer, GRect(9, 13, 60, 60));
+	  weather_layer->overlay = layer_pool_acquire();
+	  if (!weather_layer->overlay) return;
+	  AtlasSprite* icon = &weather_layer->overlay->sprite;
+	  icon_atlas_sprite_init(icon, GRect(9, 13, 60, 60), ATLAS_ICON_ERROR);
+	  layer_add_child(&weather_layer->layer, &icon->layer.layer);
+	  render_profile_wrap(&icon->layer.layer, RENDER_PROBE_NO_LINK_ICON);
       weather_layer->has_no_link_icon = true;
-      weather_layer->has_mail_icon = false; 
     }
+	// The icon spans the notification column
+	invalidate_notifications(weather_layer);
 }
 
-void weather_layer_set_weather_icon(WeatherLayer* weather_layer, WeatherIcon icon) {
-	
-	if(weather_layer->has_weather_icon) {
-		layer_remove_from_parent(&weather_layer->icon_layer3.layer.layer);
-		bmp_deinit_container(&weather_layer->icon_layer3);
-		weather_layer->has_weather_icon = false;
+static void show_weather_icon(WeatherLayer* weather_layer, WeatherIcon icon) {
+	if (weather_layer->has_weather_icon) {
+		// Only the source rectangle moves
+		icon_atlas_sprite_set(&weather_layer->weather_icon, WEATHER_ICONS[icon]);
 	}
-	
-	// Add icon
-	bmp_init_container(WEATHER_ICONS[icon], &weather_layer->icon_layer3);
-	layer_add_child(&weather_layer->layer, &weather_layer->icon_layer3.layer.layer);
-	layer_set_frame(&weather_layer->icon_layer3.layer.layer, GRect(80, 45, 30, 30));
-	weather_layer->has_weather_icon = true;
+	else {
+		icon_atlas_sprite_init(&weather_layer->weather_icon, GRect(10, 0, 30, 30), WEATHER_ICONS[icon]);
+		layer_add_child(&weather_layer->regions[WEATHER_REGION_ICON], &weather_layer->weather_icon.layer.layer);
+		render_profile_wrap(&weather_layer->weather_icon.layer.layer, RENDER_PROBE_WEATHER_ICON);
+		weather_layer->has_weather_icon = true;
+	}
+	invalidate_region(weather_layer, WEATHER_REGION_ICON);
 }
 
-void weather_layer_set_temperature(WeatherLayer* weather_layer, int16_t t) {
-	memcpy(weather_layer->temp_str, itoa(t), 4);
+static GFont weather_layer_font(WeatherLayer* weather_layer, FontSlot slot) {
+	switch (slot) {
+	case FONT_FUTURA_35: return weather_layer->font_medium;
+	case FONT_FUTURA_40: return weather_layer->font_large;
+	default: return weather_layer->font_small;
+	}
+}
+
+// Formats temperatures the lookup table doesn't cover. status_board_validate
+// and warm_start_decode keep those out, so this is a backstop: temp_str only
+// has room for three characters, the two-byte degree sign and the NUL, and
+// longer numbers are cut short rather than overrun it.
+static void show_temperature_formatted(WeatherLayer* weather_layer, int16_t t) {
+	strncpy(weather_layer->temp_str, itoa(t), 3);
+	weather_layer->temp_str[3] = '\0';
 	int degree_pos = strlen(weather_layer->temp_str);
 	
 	if (strlen(weather_layer->temp_str) == 1 || 
 		(strlen(weather_layer->temp_str) == 2 && weather_layer->temp_str[0] != '1')) {
 	  // Don't move temperature if between 0-9° or 20°-99°
-	  text_layer_set_font(&weather_layer->temp_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_18)));
+	  text_layer_set_font(&weather_layer->temp_layer, weather_layer->font_small);
 	  text_layer_set_text_alignment(&weather_layer->temp_layer, GTextAlignmentCenter);
 	  memcpy(&weather_layer->temp_str[degree_pos], "°", 3);
 	} else if (strlen(weather_layer->temp_str) == 2 && weather_layer->temp_str[0] == '1') {
 	  // Move temperature slightly to the left if between 10°-19°
-	  text_layer_set_font(&weather_layer->temp_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_18)));
+	  text_layer_set_font(&weather_layer->temp_layer, weather_layer->font_small);
 	  text_layer_set_text_alignment(&weather_layer->temp_layer, GTextAlignmentLeft);
 	  memcpy(&weather_layer->temp_str[degree_pos], "°", 3); 
 	} else if (strlen(weather_layer->temp_str) > 2) { 
 	  // Shrink font size if above 99° or below -9°
-	  text_layer_set_font(&weather_layer->temp_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_18)));
+	  text_layer_set_font(&weather_layer->temp_layer, weather_layer->font_small);
 	  text_layer_set_text_alignment(&weather_layer->temp_layer, GTextAlignmentCenter);
 	  memcpy(&weather_layer->temp_str[degree_pos], "°", 3);
 	}
 	
 	text_layer_set_text(&weather_layer->temp_layer, weather_layer->temp_str);
+	weather_layer->temp_text = NULL;
+	invalidate_region(weather_layer, WEATHER_REGION_TEMPERATURE);
 }
 
-void weather_layer_set_activation_code(WeatherLayer* weather_layer, char code[4]) {
-	if (weather_layer->has_mail_icon) {
-		layer_remove_from_parent(&weather_layer->icon_layer.layer.layer);
-		bmp_deinit_container(&weather_layer->icon_layer);
-		weather_layer->has_mail_icon = false;
+static void show_temperature(WeatherLayer* weather_layer, int16_t t) {
+	const TemperatureText* text = temperature_text_lookup(t);
+	if (!text) {
+		show_temperature_formatted(weather_layer, t);
+		return;
 	}
 	
-	if (weather_layer->has_facebook_icon) {
-	   layer_remove_from_parent(&weather_layer->icon_layer2.layer.layer);
-	   bmp_deinit_container(&weather_layer->icon_layer2);
-	   weather_layer->has_facebook_icon = false;
+	// Font and alignment rarely change between polls
+	const TemperatureText* shown = weather_layer->temp_text;
+	if (!shown || shown->font != text->font) {
+		text_layer_set_font(&weather_layer->temp_layer, weather_layer_font(weather_layer, text->font));
+	}
+	if (!shown || shown->alignment != text->alignment) {
+		text_layer_set_text_alignment(&weather_layer->temp_layer, text->alignment);
 	}
+	text_layer_set_text(&weather_layer->temp_layer, text->text);
+	weather_layer->temp_text = text;
+	invalidate_region(weather_layer, WEATHER_REGION_TEMPERATURE);
+}
+
+// The layer shows weather_layer->state.activation_code, which
+// weather_layer_apply fills in from the new state before the next draw.
+static void show_activation_code(WeatherLayer* weather_layer) {
+	hide_notification_icons(weather_layer);
+	hide_no_link_icon(weather_layer);
 	
 	if (!weather_layer->has_activation_code) {
-      layer_add_child(&weather_layer->layer, &weather_layer->activation_code_layer.layer);	
+	  weather_layer->overlay = layer_pool_acquire();
+	  if (!weather_layer->overlay) return;
+	  TextLayer* text = &weather_layer->overlay->text;
+	  text_layer_init(text, GRect(10, 0, 100, 68));
+	  text_layer_set_background_color(text, GColorClear);
+	  text_layer_set_text_alignment(text, GTextAlignmentLeft);
+	  text_layer_set_font(text, weather_layer->font_medium);
+	  text_layer_set_text(text, weather_layer->state.activation_code);
+	  render_profile_wrap(&text->layer, RENDER_PROBE_ACTIVATION_CODE);
+      layer_add_child(&weather_layer->regions[WEATHER_REGION_ACTIVATION_CODE], &text->layer);
+	  weather_layer->has_activation_code = true;
     }
-    memcpy(weather_layer->activation_code, code, 4);
-	text_layer_set_font(&weather_layer->activation_code_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_35)));
-	text_layer_set_text_alignment(&weather_layer->activation_code_layer, GTextAlignmentLeft);
-	text_layer_set_text(&weather_layer->activation_code_layer, weather_layer->activation_code);
-	weather_layer->has_activation_code = true;
+	invalidate_region(weather_layer, WEATHER_REGION_ACTIVATION_CODE);
 }
 
-void weather_layer_set_unread_facebook_messages(WeatherLayer* weather_layer, int16_t m) {
-	if (weather_layer->has_activation_code) {
-	  weather_layer->has_activation_code = false;
-	  layer_remove_from_parent(&weather_layer->activation_code_layer.layer);	
-	}
-	
-	if (m != 0) {
-	  if(!weather_layer->has_facebook_icon) {
-        // Add icon
-	    bmp_init_container(RESOURCE_ID_ICON_FACEBOOK, &weather_layer->icon_layer2);
-	    layer_add_child(&weather_layer->layer, &weather_layer->icon_layer2.layer.layer);
-	    layer_set_frame(&weather_layer->icon_layer2.layer.layer, GRect(10, 50, 20, 20));
-	    weather_layer->has_facebook_icon = true;
-	  }
-	  weather_layer->unread_facebook_messages = m;
-	  memcpy(weather_layer->facebook_messages_str, itoa(m), 4);
-	  text_layer_set_font(&weather_layer->facebook_messages_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_18)));
-	  text_layer_set_text_alignment(&weather_layer->facebook_messages_layer, GTextAlignmentLeft);
-	  text_layer_set_text(&weather_layer->facebook_messages_layer, weather_layer->facebook_messages_str);	 
-    }
-    else {
-	  if(!weather_layer->has_facebook_icon) {
-        // Add icon
-	    bmp_init_container(RESOURCE_ID_ICON_FACEBOOK, &weather_layer->icon_layer2);
-	    layer_add_child(&weather_layer->layer, &weather_layer->icon_layer2.layer.layer);
-	    layer_set_frame(&weather_layer->icon_layer2.layer.layer, GRect(10, 50, 20, 20));
-	    weather_layer->has_facebook_icon = true;
-      }	
-	  weather_layer->unread_facebook_messages = 0;
-	  memcpy(weather_layer->facebook_messages_str, "0", 4);
-	  text_layer_set_font(&weather_layer->facebook_messages_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_18)));
-	  text_layer_set_text_alignment(&weather_layer->facebook_messages_layer, GTextAlignmentLeft);
-	  text_layer_set_text(&weather_layer->facebook_messages_layer, weather_layer->facebook_messages_str);
-    }
+static void show_unread(WeatherLayer* weather_layer, NotificationSource source, int16_t m) {
+	hide_no_link_icon(weather_layer);
+	
+	NotificationSlot* slot = &weather_layer->notifications[source];
+	if (!slot->has_icon) {
+	  icon_atlas_sprite_init(&slot->icon, GRect(10, notification_content_top(source), 20, 20),
+		NOTIFICATION_SOURCE_INFO[source].icon);
+	  layer_add_child(&slot->region, &slot->icon.layer.layer);
+	  render_profile_wrap(&slot->icon.layer.layer, RENDER_PROBE_NOTIFICATION_ICON);
+	  slot->has_icon = true;
+	}
+	memcpy(slot->count_str, itoa(m), 4);
+	text_layer_set_text(&slot->count_layer, slot->count_str);
+	invalidate_layer(&slot->region);
 }
 
-void weather_layer_set_unread_messages(WeatherLayer* weather_layer, int16_t m) {
-	if (weather_layer->has_activation_code) {
-		weather_layer->has_activation_code = false;
-	  layer_remove_from_parent(&weather_layer->activation_code_layer.layer);	
+/* Bring the layer from its current state to new_state, touching only the
+* sub-layers whose value differs. The activation code takes over the left
+* side of the panel, then the no-link icon, then the unread counts.
+*/
+bool weather_layer_apply(WeatherLayer* weather_layer, const WeatherLayerState* new_state) {
+	const WeatherLayerState* old = &weather_layer->state;
+	bool changed = false;
+#ifdef PERF_COUNTERS
+	uint32_t pixels = perf_counters[PERF_DIRTY_PIXELS];
+#endif
+	// Leaving the activation or no-link screen means the counts must be
+	// shown again even if their values did not move.
+	bool left_mode = (old->has_activation_code && !new_state->has_activation_code) ||
+		(old->link_lost && !new_state->link_lost);
+	
+	// Gives the pool slot back before the no-link icon asks for it
+	if (!new_state->has_activation_code && weather_layer->has_activation_code) {
+		hide_activation_code(weather_layer);
+		changed = true;
 	}
 	
-	if (weather_layer->has_no_link_icon) {
-		layer_remove_from_parent(&weather_layer->icon_layer.layer.layer);
-		bmp_deinit_container(&weather_layer->icon_layer);
-		weather_layer->has_no_link_icon = false;
+	if (new_state->has_activation_code) {
+		if (!old->has_activation_code ||
+			strncmp(old->activation_code, new_state->activation_code, sizeof(old->activation_code))) {
+			show_activation_code(weather_layer);
+			changed = true;
+		}
+	}
+	else if (new_state->link_lost) {
+		if (!old->link_lost) {
+			show_no_link_icon(weather_layer);
+			changed = true;
+		}
+	}
+	else {
+		if (old->link_lost) {
+			hide_no_link_icon(weather_layer);
+			changed = true;
+		}
+		for (int i = 0; i < NOTIFICATION_SOURCE_COUNT; i++) {
+			uint8_t bit = 1 << i;
+			if ((new_state->has_unread & bit) && (left_mode || !(old->has_unread & bit) ||
+				old->unread[i] != new_state->unread[i])) {
+				show_unread(weather_layer, i, new_state->unread[i]);
+				changed = true;
+			}
+		}
 	}
 	
-	if (m != 0) {
-	  if (!weather_layer->has_mail_icon) {
-	    bmp_init_container(RESOURCE_ID_ICON_EMAIL, &weather_layer->icon_layer);
-        layer_add_child(&weather_layer->layer, &weather_layer->icon_layer.layer.layer);
-  	    layer_set_frame(&weather_layer->icon_layer.layer.layer, GRect(10, 19, 20, 20));
-	    weather_layer->has_mail_icon = true;
-	  }
-	  weather_layer->unread_messages = m;
-	  memcpy(weather_layer->messages_str, itoa(m), 4);
-	  text_layer_set_font(&weather_layer->messages_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_18)));
-	  text_layer_set_text_alignment(&weather_layer->messages_layer, GTextAlignmentLeft);
-	  text_layer_set_text(&weather_layer->messages_layer, weather_layer->messages_str);	 
-    }
-    else {
-	  if (!weather_layer->has_mail_icon) {
-	    bmp_init_container(RESOURCE_ID_ICON_EMAIL, &weather_layer->icon_layer);
-        layer_add_child(&weather_layer->layer, &weather_layer->icon_layer.layer.layer);
-  	    layer_set_frame(&weather_layer->icon_layer.layer.layer, GRect(10, 19, 20, 20));
-	    weather_layer->has_mail_icon = true;
-	  }
-	  weather_layer->unread_messages = 0;
-	  memcpy(weather_layer->messages_str, "0", 4);
-	  text_layer_set_font(&weather_layer->messages_layer, fonts_load_custom_font(resource_get_handle(RESOURCE_ID_FUTURA_18)));
-	  text_layer_set_text_alignment(&weather_layer->messages_layer, GTextAlignmentLeft);
-	  text_layer_set_text(&weather_layer->messages_layer, weather_layer->messages_str);
-    }
+	if (new_state->has_icon && (!old->has_icon || old->icon != new_state->icon)) {
+		show_weather_icon(weather_layer, new_state->icon);
+		changed = true;
+	}
+	if (new_state->has_temperature && (!old->has_temperature || old->temperature != new_state->temperature)) {
+		show_temperature(weather_layer, new_state->temperature);
+		changed = true;
+	}
+	
+	weather_layer->state = *new_state;
+	if (!changed) {
+		weather_layer->redraws_avoided++;
+	}
+#ifdef PERF_COUNTERS
+	else {
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "weather_layer_apply repainted %lu px",
+			perf_counters[PERF_DIRTY_PIXELS] - pixels);
+	}
+#endif
+	return changed;
+}
+
+void weather_layer_set_no_link_icon(WeatherLayer* weather_layer) {
+	WeatherLayerState state = weather_layer->state;
+	state.link_lost = true;
+	weather_layer_apply(weather_layer, &state);
+}
+
+void weather_layer_set_weather_icon(WeatherLayer* weather_layer, WeatherIcon icon) {
+	WeatherLayerState state = weather_layer->state;
+	state.has_icon = true;
+	state.icon = icon;
+	weather_layer_apply(weather_layer, &state);
+}
+
+void weather_layer_set_temperature(WeatherLayer* weather_layer, int16_t t) {
+	WeatherLayerState state = weather_layer->state;
+	state.has_temperature = true;
+	state.temperature = t;
+	weather_layer_apply(weather_layer, &state);
+}
+
+void weather_layer_set_activation_code(WeatherLayer* weather_layer, char code[4]) {
+	WeatherLayerState state = weather_layer->state;
+	state.has_activation_code = true;
+	memcpy(state.activation_code, code, 4);
+	state.activation_code[4] = '\0';
+	weather_layer_apply(weather_layer, &state);
+}
+
+void weather_layer_set_unread(WeatherLayer* weather_layer, NotificationSource source, int16_t m) {
+	WeatherLayerState state = weather_layer->state;
+	state.has_activation_code = false;
+	state.link_lost = false;
+	state.has_unread |= 1 << source;
+	state.unread[source] = m;
+	weather_layer_apply(weather_layer, &state);
 }
 
 void weather_layer_deinit(WeatherLayer* weather_layer) {
-	if (weather_layer->has_mail_icon || weather_layer->has_no_link_icon)
-		bmp_deinit_container(&weather_layer->icon_layer);
-	if (weather_layer->has_facebook_icon)
-	   bmp_deinit_container(&weather_layer->icon_layer2);
-	if (weather_layer->has_weather_icon)
-		bmp_deinit_container(&weather_layer->icon_layer3);
-}
\ No newline at end of file
+	hide_no_link_icon(weather_layer);
+	hide_activation_code(weather_layer);
+	icon_atlas_deinit();
+	
+	font_registry_release(FONT_FUTURA_18);
+	font_registry_release(FONT_FUTURA_35);
+	font_registry_release(FONT_FUTURA_40);
+}
+
+#ifdef PERF_COUNTERS
+void weather_layer_benchmark_temperature(WeatherLayer* weather_layer) {
+	const uint32_t count = TEMPERATURE_TEXT_MAX - TEMPERATURE_TEXT_MIN + 1;
+	perf_cycles_init();
+	
+	uint32_t start = perf_cycles();
+	for (int16_t t = TEMPERATURE_TEXT_MIN; t <= TEMPERATURE_TEXT_MAX; t++) {
+		show_temperature_formatted(weather_layer, t);
+	}
+	uint32_t formatted = perf_cycles() - start;
+	
+	start = perf_cycles();
+	for (int16_t t = TEMPERATURE_TEXT_MIN; t <= TEMPERATURE_TEXT_MAX; t++) {
+		show_temperature(weather_layer, t);
+	}
+	uint32_t table = perf_cycles() - start;
+	
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "temperature cycles/set: itoa=%lu table=%lu",
+		formatted / count, table / count);
+	
+	// Put the layer back the way weather_layer_init left it
+	text_layer_set_text(&weather_layer->temp_layer, "");
+	text_layer_set_text_alignment(&weather_layer->temp_layer, GTextAlignmentCenter);
+	text_layer_set_font(&weather_layer->temp_layer, weather_layer->font_large);
+	weather_layer->temp_text = NULL;
+}
+#endif
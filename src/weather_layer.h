@@ -1,19 +1,10 @@
 #ifndef WEATHER_LAYER_H
 #define WEATHER_LAYER_H
 
-typedef struct {
-	Layer layer;
-	BmpContainer icon_layer;
-	TextLayer temp_layer;
-	TextLayer temp_layer_background;
-	TextLayer messages_layer;
-	TextLayer messages_layer_background;
-	bool has_weather_icon;
-	bool has_mail_icon;
-	char temp_str[5];
-	char messages_str[5];
-	int16_t unread_messages;
-} WeatherLayer;
+#include "notification_source.h"
+#include "icon_atlas.h"
+#include "layer_pool.h"
+#include "temperature_text.h"
 
 typedef enum {
 	WEATHER_ICON_CLEAR_DAY = 0,
@@ -30,12 +21,74 @@ typedef enum {
 	WEATHER_ICON_COUNT
 } WeatherIcon;
 
+// What the panel shows. weather_layer_apply diffs one of these against the
+// current state and only touches the sub-layers that changed.
+typedef struct {
+	bool has_icon;
+	bool has_temperature;
+	bool has_activation_code;
+	bool link_lost;
+	uint8_t has_unread;		// one bit per NotificationSource
+	WeatherIcon icon;
+	int16_t temperature;
+	int16_t unread[NOTIFICATION_SOURCE_COUNT];
+	char activation_code[5];
+} WeatherLayerState;
+
+// Separately invalidated parts of the panel. Each has its own white
+// background, so a change repaints only its rectangle. Every notification
+// slot is a region of its own as well.
+typedef enum {
+	WEATHER_REGION_TEMPERATURE = 0,
+	WEATHER_REGION_ICON,
+	WEATHER_REGION_ACTIVATION_CODE,	// transparent, drawn over the others
+	WEATHER_REGION_COUNT
+} WeatherRegion;
+
+// One row of the notification column
+typedef struct {
+	Layer region;
+	TextLayer count_layer;
+	AtlasSprite icon;
+	bool has_icon;
+	char count_str[5];
+} NotificationSlot;
+
+typedef struct {
+	Layer layer;
+	Layer regions[WEATHER_REGION_COUNT];
+	NotificationSlot notifications[NOTIFICATION_SOURCE_COUNT];
+	// Activation code or no-link icon, borrowed from the layer pool while
+	// one of them is on screen
+	PooledLayer* overlay;
+	AtlasSprite weather_icon;
+	TextLayer temp_layer;
+	GFont font_small;
+	GFont font_medium;
+	GFont font_large;
+	bool has_weather_icon;
+	bool has_no_link_icon;
+	bool has_activation_code;
+	char temp_str[6];
+	const TemperatureText* temp_text;	// NULL when temp_str is shown
+	WeatherLayerState state;
+	// Number of weather_layer_apply calls that found nothing to change. The
+	// host day reports it (make -C host run).
+	uint32_t redraws_avoided;
+} WeatherLayer;
+
 void weather_layer_init(WeatherLayer* weather_layer, GPoint pos);
 void weather_layer_deinit(WeatherLayer* weather_layer);
-void weather_layer_set_icon(WeatherLayer* weather_layer, WeatherIcon icon);
+bool weather_layer_apply(WeatherLayer* weather_layer, const WeatherLayerState* new_state);
+void weather_layer_set_no_link_icon(WeatherLayer* weather_layer);
+void weather_layer_set_weather_icon(WeatherLayer* weather_layer, WeatherIcon icon);
 void weather_layer_set_temperature(WeatherLayer* weather_layer, int16_t temperature);
-void weather_layer_set_unread_messages(WeatherLayer* weather_layer, int16_t unread_messages, int16_t vibrate);
+void weather_layer_set_unread(WeatherLayer* weather_layer, NotificationSource source, int16_t unread);
 void weather_layer_set_activation_code(WeatherLayer* weather_layer, char code[4]);
 
+// Times the temperature lookup table against formatting with itoa over the
+// table's range and logs cycles per set. Only built with PERF_COUNTERS.
+void weather_layer_benchmark_temperature(WeatherLayer* weather_layer);
+
 
 #endif
@@ -0,0 +1,87 @@
+#include "pebble_os.h"
+#include "pebble_app.h"
+#include "work_scheduler.h"
+#include "config.h"
+#include "perf.h"
+
+typedef struct {
+	WorkTask task;
+	void* data;
+} WorkItem;
+
+static AppContextRef app_context;
+static WorkItem queue[WORK_QUEUE_CAPACITY];
+static uint8_t queue_head;
+static bool timer_armed;
+static WorkStats stats;
+
+void work_scheduler_init(AppContextRef ctx) {
+	app_context = ctx;
+	queue_head = 0;
+	timer_armed = false;
+	memset(&stats, 0, sizeof(stats));
+#ifdef PERF_COUNTERS
+	perf_cycles_init();
+#endif
+}
+
+static void arm_timer() {
+	if (timer_armed || stats.depth == 0) return;
+	app_timer_send_event(app_context, WORK_SLICE_DELAY_MS, WORK_TIMER_COOKIE);
+	timer_armed = true;
+}
+
+static bool run_next() {
+	if (stats.depth == 0) return false;
+	WorkItem item = queue[queue_head];
+	queue_head = (queue_head + 1) % WORK_QUEUE_CAPACITY;
+	stats.depth--;
+	stats.ran++;
+	item.task(item.data);
+	return true;
+}
+
+void work_scheduler_defer(WorkTask task, void* data) {
+	for (int i = 0; i < stats.depth; i++) {
+		WorkItem* item = &queue[(queue_head + i) % WORK_QUEUE_CAPACITY];
+		if (item->task == task && item->data == data) {
+			stats.coalesced++;
+			return;
+		}
+	}
+	if (stats.depth == WORK_QUEUE_CAPACITY) {
+		// Late is better than lost
+		stats.overflowed++;
+		task(data);
+		return;
+	}
+	queue[(queue_head + stats.depth) % WORK_QUEUE_CAPACITY] = (WorkItem){ .task = task, .data = data };
+	stats.depth++;
+	stats.deferred++;
+	if (stats.depth > stats.max_depth) stats.max_depth = stats.depth;
+	arm_timer();
+}
+
+bool work_scheduler_timer(uint32_t cookie) {
+	if (cookie != WORK_TIMER_COOKIE) return false;
+	timer_armed = false;
+#ifdef PERF_COUNTERS
+	uint32_t start = perf_cycles();
+#endif
+	for (int i = 0; i < WORK_SLICE_TASKS && run_next(); i++);
+#ifdef PERF_COUNTERS
+	uint32_t cycles = perf_cycles() - start;
+	if (cycles > stats.worst_slice_cycles) {
+		stats.worst_slice_cycles = cycles;
+#ifdef DEBUG
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "work slice worst=%lu cycles", cycles);
+#endif
+	}
+#endif
+	arm_timer();
+	return true;
+}
+
+const WorkStats* work_scheduler_stats() {
+	return &stats;
+}
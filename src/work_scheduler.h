@@ -0,0 +1,39 @@
+#ifndef WORK_SCHEDULER_H
+#define WORK_SCHEDULER_H
+
+// Cooperative work queue on top of app timers. Handlers do their urgent part
+// (drawing the time) inline and defer the rest, which then runs a few tasks
+// per timer callback so the event loop gets to render in between.
+
+typedef void (*WorkTask)(void* data);
+
+#define WORK_QUEUE_CAPACITY 8
+// Tasks run per timer callback, and the gap before the next callback
+#define WORK_SLICE_TASKS 1
+#define WORK_SLICE_DELAY_MS 20
+#define WORK_TIMER_COOKIE 0x574F524B
+
+typedef struct {
+	uint16_t depth;
+	uint16_t max_depth;
+	uint32_t deferred;
+	uint32_t coalesced;		// already queued with the same data
+	uint32_t overflowed;	// queue full, ran inline instead
+	uint32_t ran;
+	// Longest timer callback in DWT cycles; only measured with PERF_COUNTERS
+	uint32_t worst_slice_cycles;
+} WorkStats;
+
+void work_scheduler_init(AppContextRef ctx);
+
+// Queues task to run in a later slice. A task already queued with the same
+// data is not queued twice.
+void work_scheduler_defer(WorkTask task, void* data);
+
+// Call from the app's timer handler. Returns false if the cookie belongs to
+// someone else.
+bool work_scheduler_timer(uint32_t cookie);
+
+const WorkStats* work_scheduler_stats();
+
+#endif // WORK_SCHEDULER_H
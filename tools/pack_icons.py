@@ -0,0 +1,194 @@
+#!/usr/bin/env python
+"""Packs the icon PNGs into one 1-bit atlas and writes its offset table.
+
+Run from the repository root after changing an icon:
+
+    python tools/pack_icons.py
+
+Writes resources/src/images/icon_atlas.png, which resource_map.json lists as
+ICON_ATLAS, and src/icon_atlas_table.h. Needs nothing beyond the standard
+library.
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), os.pardir)
+IMAGES = os.path.join(ROOT, 'resources', 'src', 'images')
+ATLAS_PNG = os.path.join(IMAGES, 'icon_atlas.png')
+TABLE_H = os.path.join(ROOT, 'src', 'icon_atlas_table.h')
+
+# Row order is the AtlasIcon order. The weather icons follow WeatherIcon.
+ICONS = [
+    ('ATLAS_ICON_CLEAR_DAY', 'clear-day.png'),
+    ('ATLAS_ICON_CLEAR_NIGHT', 'clear-night.png'),
+    ('ATLAS_ICON_RAIN', 'rain.png'),
+    ('ATLAS_ICON_SNOW', 'snow.png'),
+    ('ATLAS_ICON_SLEET', 'sleet.png'),
+    ('ATLAS_ICON_WIND', 'wind.png'),
+    ('ATLAS_ICON_FOG', 'fog.png'),
+    ('ATLAS_ICON_CLOUDY', 'cloudy.png'),
+    ('ATLAS_ICON_PARTLY_CLOUDY_DAY', 'partly-cloudy-day.png'),
+    ('ATLAS_ICON_PARTLY_CLOUDY_NIGHT', 'partly-cloudy-night.png'),
+    ('ATLAS_ICON_ERROR', 'error.png'),
+    ('ATLAS_ICON_EMAIL', 'email.png'),
+    ('ATLAS_ICON_FACEBOOK', 'fb.png'),
+]
+
+# A multiple of 32 keeps the firmware's rows word aligned without padding
+ATLAS_WIDTH = 128
+
+# Pixels darker than this become black
+THRESHOLD = 128
+
+PNG_SIGNATURE = b'\x89PNG\r\n\x1a\n'
+CHANNELS = {0: 1, 2: 3, 4: 2, 6: 4}
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    """Returns (width, height, rows) with one 0/1 value per pixel, 1 = white."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != PNG_SIGNATURE:
+        raise ValueError('%s: not a PNG' % path)
+
+    pos = 8
+    idat = b''
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', chunk)
+        elif kind == b'IDAT':
+            idat += chunk
+    if depth != 8 or color not in CHANNELS or interlace:
+        raise ValueError('%s: only 8-bit, non-interlaced gray or RGB(A) is supported' % path)
+
+    channels = CHANNELS[color]
+    stride = width * channels
+    raw = bytearray(zlib.decompress(idat))
+    previous = bytearray(stride)
+    rows = []
+    for y in range(height):
+        start = y * (stride + 1)
+        kind = raw[start]
+        line = raw[start + 1:start + 1 + stride]
+        for i in range(stride):
+            left = line[i - channels] if i >= channels else 0
+            up = previous[i]
+            up_left = previous[i - channels] if i >= channels else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((left + up) >> 1)) & 0xFF
+            elif kind == 4:
+                line[i] = (line[i] + paeth(left, up, up_left)) & 0xFF
+        previous = line
+
+        row = []
+        for x in range(width):
+            pixel = line[x * channels:(x + 1) * channels]
+            if color in (0, 4):
+                luma = pixel[0]
+            else:
+                luma = (299 * pixel[0] + 587 * pixel[1] + 114 * pixel[2]) // 1000
+            # Transparent pixels show the white panel
+            if color in (4, 6) and pixel[-1] < 128:
+                luma = 255
+            row.append(1 if luma >= THRESHOLD else 0)
+        rows.append(row)
+    return width, height, rows
+
+
+def write_png(path, width, height, rows):
+    """Writes a 1-bit grayscale PNG."""
+    raw = bytearray()
+    for row in rows:
+        raw.append(0)
+        for x in range(0, width, 8):
+            byte = 0
+            for bit, value in enumerate(row[x:x + 8]):
+                byte |= value << (7 - bit)
+            raw.append(byte)
+
+    def chunk(kind, body):
+        return (struct.pack('>I', len(body)) + kind + body +
+                struct.pack('>I', zlib.crc32(kind + body) & 0xFFFFFFFF))
+
+    with open(path, 'wb') as f:
+        f.write(PNG_SIGNATURE)
+        f.write(chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, 1, 0, 0, 0, 0)))
+        f.write(chunk(b'IDAT', zlib.compress(bytes(raw), 9)))
+        f.write(chunk(b'IEND', b''))
+
+
+def pack(sizes):
+    """Places rectangles, largest first, at the topmost then leftmost free
+    spot in a strip ATLAS_WIDTH wide. Returns positions and the strip height."""
+    placed = {}
+    order = sorted(range(len(sizes)), key=lambda i: (-sizes[i][0] * sizes[i][1], i))
+    for i in order:
+        w, h = sizes[i]
+        if w > ATLAS_WIDTH:
+            raise ValueError('icon %d is wider than the atlas' % i)
+        y = 0
+        while i not in placed:
+            for x in range(ATLAS_WIDTH - w + 1):
+                if not any(x < px + sizes[j][0] and px < x + w and
+                           y < py + sizes[j][1] and py < y + h
+                           for j, (px, py) in placed.items()):
+                    placed[i] = (x, y)
+                    break
+            y += 1
+    height = max(placed[i][1] + sizes[i][1] for i in placed)
+    return [placed[i] for i in range(len(sizes))], height
+
+
+def main():
+    icons = [read_png(os.path.join(IMAGES, name)) for _, name in ICONS]
+    positions, height = pack([(w, h) for w, h, _ in icons])
+
+    atlas = [[1] * ATLAS_WIDTH for _ in range(height)]
+    for (w, h, rows), (x, y) in zip(icons, positions):
+        for dy in range(h):
+            atlas[y + dy][x:x + w] = rows[dy]
+    write_png(ATLAS_PNG, ATLAS_WIDTH, height, atlas)
+
+    lines = [
+        '// Generated by tools/pack_icons.py. Do not edit.',
+        '#ifndef ICON_ATLAS_TABLE_H',
+        '#define ICON_ATLAS_TABLE_H',
+        '',
+        '#define ICON_ATLAS_WIDTH %d' % ATLAS_WIDTH,
+        '#define ICON_ATLAS_HEIGHT %d' % height,
+        '',
+        '// X(icon, x, y, w, h)',
+        '#define ICON_ATLAS_ICONS(X) \\',
+    ]
+    rows = ['\tX(%s, %d, %d, %d, %d)' % (symbol, x, y, w, h)
+            for (symbol, _), (w, h, _), (x, y) in zip(ICONS, icons, positions)]
+    lines.append(' \\\n'.join(rows))
+    lines += ['', '#endif // ICON_ATLAS_TABLE_H', '']
+    with open(TABLE_H, 'w') as f:
+        f.write('\n'.join(lines))
+
+    used = sum(w * h for w, h, _ in icons)
+    sys.stdout.write('%dx%d atlas, %d%% used, %d bytes at 1 bit\n' % (
+        ATLAS_WIDTH, height, 100 * used // (ATLAS_WIDTH * height), ATLAS_WIDTH * height // 8))
+
+
+if __name__ == '__main__':
+    main()